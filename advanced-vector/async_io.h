@@ -0,0 +1,484 @@
+#pragma once
+
+#include "vector.h"
+#include "file_io.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <future>
+#include <optional>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define ADVANCED_VECTOR_HAS_IO_URING 1
+#else
+#define ADVANCED_VECTOR_HAS_IO_URING 0
+#endif
+
+#include <sys/stat.h>
+#if defined(__linux__)
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
+
+struct AsyncIoOptions {
+    // Размер одного запроса; при ненулевом alignment округляется до него вверх
+    size_t chunk_bytes = size_t{1} << 20;
+    // Выравнивание для дескрипторов с O_DIRECT (см. DirectIoAlignment), 0 — без
+    // выравнивания. Степень двойки не больше MAX_DIRECT_IO_ALIGNMENT. AsyncLoad
+    // читает выровненный охват диапазона в выровненный промежуточный буфер;
+    // AsyncStore копирует данные в такой буфер и требует выровненных
+    // смещения и длины, иначе бросает std::invalid_argument
+    size_t alignment = 0;
+    // Сколько запросов io_uring держать в полёте одновременно
+    unsigned queue_depth = 32;
+    // false — сразу использовать пул потоков с pread/pwrite
+    bool use_io_uring = true;
+    // Пул для запасного пути; по умолчанию DefaultThreadPool()
+    ThreadPool* pool = nullptr;
+};
+
+inline constexpr size_t MAX_DIRECT_IO_ALIGNMENT = 4096;
+
+// Выравнивание адреса буфера, смещения и длины, которого требует O_DIRECT для fd.
+// Берётся из statx (STATX_DIOALIGN, Linux 6.1+) или размера сектора блочного
+// устройства; если ядро не сообщает, — размер страницы MAX_DIRECT_IO_ALIGNMENT
+inline size_t DirectIoAlignment(int fd) noexcept {
+#if defined(__linux__) && defined(STATX_DIOALIGN)
+    struct statx stx{};
+    if (::statx(fd, "", AT_EMPTY_PATH, STATX_DIOALIGN, &stx) == 0 && (stx.stx_mask & STATX_DIOALIGN) != 0
+        && stx.stx_dio_offset_align != 0) {
+        return std::max<size_t>(stx.stx_dio_mem_align, stx.stx_dio_offset_align);
+    }
+#endif
+#if defined(__linux__)
+    struct stat st{};
+    int sector = 0;
+    if (::fstat(fd, &st) == 0 && S_ISBLK(st.st_mode) && ::ioctl(fd, BLKSSZGET, &sector) == 0 && sector > 0) {
+        return static_cast<size_t>(sector);
+    }
+#endif
+    return MAX_DIRECT_IO_ALIGNMENT;
+}
+
+namespace async_io_detail {
+
+// Ограничения io_uring: длина запроса — 32 бита, глубина очереди — IORING_MAX_ENTRIES
+inline constexpr size_t MAX_REQUEST_BYTES = size_t{1} << 30;
+inline constexpr unsigned MAX_QUEUE_DEPTH = 4096;
+
+// Один запрос ввода-вывода: остаток участка буфера и его позиция в файле.
+// Конец файла допустим после первых required байт: так читается выровненный
+// хвост, выходящий за конец файла
+struct Request {
+    char* data;
+    size_t size;
+    off_t offset;
+    size_t required;
+};
+
+// Блок промежуточного буфера, выровненный для O_DIRECT
+struct alignas(MAX_DIRECT_IO_ALIGNMENT) DirectIoBlock {
+    char bytes[MAX_DIRECT_IO_ALIGNMENT];
+};
+
+inline size_t CheckAlignment(size_t alignment) {
+    if (alignment > MAX_DIRECT_IO_ALIGNMENT || (alignment & (alignment - 1)) != 0) {
+        throw std::invalid_argument("AsyncIoOptions: alignment must be a power of two up to 4096");
+    }
+    return std::max<size_t>(alignment, 1);
+}
+
+// Делит size байт на запросы по chunk_bytes, кратные alignment. Обязательны
+// первые required байт, остальные — выравнивающий хвост
+inline Vector<Request> SplitRequests(char* data, size_t size, size_t required, off_t offset, size_t chunk_bytes,
+                                     size_t alignment) {
+    chunk_bytes = std::clamp<size_t>(chunk_bytes, 1, MAX_REQUEST_BYTES / alignment * alignment);
+    chunk_bytes = (chunk_bytes + alignment - 1) / alignment * alignment;
+    Vector<Request> requests;
+    requests.Reserve((size + chunk_bytes - 1) / chunk_bytes);
+    for (size_t done = 0; done < size; done += chunk_bytes) {
+        const size_t chunk = std::min(chunk_bytes, size - done);
+        const size_t chunk_required = required > done ? std::min(chunk, required - done) : 0;
+        requests.PushBack(Request{data + done, chunk, offset + static_cast<off_t>(done), chunk_required});
+    }
+    return requests;
+}
+
+// Читает запрос блокирующим pread, дочитывая после неполных чтений
+inline void ReadRequest(int fd, Request request) {
+    while (request.required != 0) {
+        const ssize_t got = ::pread(fd, request.data, request.size, request.offset);
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            io_detail::ThrowErrno("pread");
+        }
+        if (got == 0) {
+            throw std::system_error(std::make_error_code(std::errc::io_error), "pread: unexpected end of file");
+        }
+        const auto done = static_cast<size_t>(got);
+        request.required -= std::min(done, request.required);
+        request.data += done;
+        request.size -= done;
+        request.offset += got;
+    }
+}
+
+#if ADVANCED_VECTOR_HAS_IO_URING
+
+// Минимальная обёртка над io_uring через системные вызовы, без liburing.
+// Кольца отправки и завершения используются одним потоком
+class IoUring {
+public:
+    explicit IoUring(unsigned entries) {
+        io_uring_params params{};
+        fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+        if (fd_ < 0) {
+            io_detail::ThrowErrno("io_uring_setup");
+        }
+        sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+            sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+        }
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        try {
+            sq_ring_ = Map(sq_ring_size_, IORING_OFF_SQ_RING);
+            cq_ring_ = (params.features & IORING_FEAT_SINGLE_MMAP) != 0 ? sq_ring_ : Map(cq_ring_size_, IORING_OFF_CQ_RING);
+            sqes_ = static_cast<io_uring_sqe*>(Map(sqes_size_, IORING_OFF_SQES));
+        } catch (...) {
+            Unmap();
+            throw;
+        }
+        char* sq = static_cast<char*>(sq_ring_);
+        sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        char* cq = static_cast<char*>(cq_ring_);
+        cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        entries_ = params.sq_entries;
+    }
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    ~IoUring() {
+        Unmap();
+    }
+
+    unsigned Entries() const noexcept {
+        return entries_;
+    }
+
+    // Добавляет запрос в кольцо отправки; ядро увидит его после Submit
+    void Prepare(int fd, bool write, const Request& request, uint64_t user_data) noexcept {
+        const unsigned tail = *sq_tail_;
+        const unsigned index = tail & sq_mask_;
+        io_uring_sqe& sqe = sqes_[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = write ? IORING_OP_WRITE : IORING_OP_READ;
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<uint64_t>(request.data);
+        sqe.len = static_cast<uint32_t>(request.size);
+        sqe.off = static_cast<uint64_t>(request.offset);
+        sqe.user_data = user_data;
+        sq_array_[index] = index;
+        __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+        ++to_submit_;
+    }
+
+    // Отправляет подготовленные запросы и ждёт хотя бы wait_count завершений
+    void Submit(unsigned wait_count) {
+        for (;;) {
+            const long result = ::syscall(__NR_io_uring_enter, fd_, to_submit_, wait_count,
+                                          wait_count != 0 ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0);
+            if (result >= 0) {
+                to_submit_ -= static_cast<unsigned>(result);
+                if (to_submit_ == 0) {
+                    return;
+                }
+                continue;
+            }
+            if (errno != EINTR) {
+                io_detail::ThrowErrno("io_uring_enter");
+            }
+        }
+    }
+
+    // Ждёт хотя бы wait_count завершений, не отправляя новых запросов.
+    // Ошибку не бросает: вызывается при уже случившейся ошибке, когда
+    // нужно лишь дождаться запросов, принятых ядром
+    bool Wait(unsigned wait_count) noexcept {
+        const long result = ::syscall(__NR_io_uring_enter, fd_, 0u, wait_count, IORING_ENTER_GETEVENTS, nullptr, 0);
+        return result >= 0 || errno == EINTR;
+    }
+
+    // Подготовленные запросы, которые ядро ещё не приняло
+    unsigned Unsubmitted() const noexcept {
+        return to_submit_;
+    }
+
+    // Поддерживает ли ядро операцию opcode. IORING_OP_READ/WRITE появились в 5.6
+    // вместе с IORING_REGISTER_PROBE, поэтому на старых ядрах ошибка самой
+    // пробы тоже означает «нет»
+    bool Supports(unsigned opcode) const noexcept {
+        constexpr unsigned OPS = 256;
+        alignas(io_uring_probe) unsigned char buffer[sizeof(io_uring_probe) + OPS * sizeof(io_uring_probe_op)] = {};
+        auto* probe = reinterpret_cast<io_uring_probe*>(buffer);
+        if (::syscall(__NR_io_uring_register, fd_, IORING_REGISTER_PROBE, probe, OPS) < 0) {
+            return false;
+        }
+        return opcode <= probe->last_op && opcode < probe->ops_len
+               && (probe->ops[opcode].flags & IO_URING_OP_SUPPORTED) != 0;
+    }
+
+    // Забирает одно завершение, если оно есть
+    bool TryReap(uint64_t& user_data, int& result) noexcept {
+        const unsigned head = *cq_head_;
+        if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+            return false;
+        }
+        const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+        user_data = cqe.user_data;
+        result = cqe.res;
+        __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+
+private:
+    void* Map(size_t size, off_t offset) {
+        void* ptr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, offset);
+        if (ptr == MAP_FAILED) {
+            io_detail::ThrowErrno("mmap");
+        }
+        return ptr;
+    }
+
+    void Unmap() noexcept {
+        if (sqes_ != nullptr) {
+            ::munmap(sqes_, sqes_size_);
+        }
+        if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+            ::munmap(cq_ring_, cq_ring_size_);
+        }
+        if (sq_ring_ != nullptr) {
+            ::munmap(sq_ring_, sq_ring_size_);
+        }
+        ::close(fd_);
+    }
+
+    int fd_ = -1;
+    unsigned entries_ = 0;
+    unsigned to_submit_ = 0;
+    void* sq_ring_ = nullptr;
+    void* cq_ring_ = nullptr;
+    io_uring_sqe* sqes_ = nullptr;
+    size_t sq_ring_size_ = 0;
+    size_t cq_ring_size_ = 0;
+    size_t sqes_size_ = 0;
+    unsigned* sq_tail_ = nullptr;
+    unsigned* sq_array_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+};
+
+// Выполняет запросы через io_uring, держа в полёте до Entries() штук.
+// Неполные чтения и записи дозапрашиваются. После первой ошибки, в том
+// числе самого io_uring_enter, новые запросы не отправляются, а принятые
+// ядром дожидаются: кольцо нельзя закрывать, пока ядро пишет в буферы
+inline void RunUring(IoUring& ring, int fd, bool write, Vector<Request>& requests) {
+    size_t next = 0;
+    size_t in_flight = 0;
+    std::exception_ptr error;
+    auto fail = [&error](std::exception_ptr e) {
+        if (!error) {
+            error = std::move(e);
+        }
+    };
+    for (;;) {
+        while (!error && next < requests.Size() && in_flight < ring.Entries()) {
+            ring.Prepare(fd, write, requests[next], next);
+            ++next;
+            ++in_flight;
+        }
+        // После ошибки запросы, не принятые ядром, уже не выполнятся
+        if (in_flight == 0 || (error && in_flight == ring.Unsubmitted())) {
+            break;
+        }
+        if (!error) {
+            try {
+                ring.Submit(1);
+            } catch (...) {
+                fail(std::current_exception());
+            }
+        } else if (!ring.Wait(1)) {
+            std::this_thread::yield();
+        }
+        uint64_t index = 0;
+        int result = 0;
+        while (ring.TryReap(index, result)) {
+            --in_flight;
+            Request& request = requests[index];
+            if (result < 0) {
+                fail(std::make_exception_ptr(std::system_error(-result, std::generic_category(),
+                                                                write ? "io_uring write" : "io_uring read")));
+                continue;
+            }
+            if (result == 0) {
+                fail(std::make_exception_ptr(std::system_error(std::make_error_code(std::errc::io_error),
+                                                                "io_uring: unexpected end of file")));
+                continue;
+            }
+            const auto done = static_cast<size_t>(result);
+            request.required -= std::min(done, request.required);
+            if (done < request.size && request.required != 0 && !error) {
+                request.data += done;
+                request.size -= done;
+                request.offset += result;
+                ring.Prepare(fd, write, request, index);
+                ++in_flight;
+            }
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+// Проверяется один раз на процесс по первому созданному кольцу
+inline bool UringSupportsReadWrite(const IoUring& ring) noexcept {
+    static const bool supported = ring.Supports(IORING_OP_READ) && ring.Supports(IORING_OP_WRITE);
+    return supported;
+}
+
+#endif  // ADVANCED_VECTOR_HAS_IO_URING
+
+// Запасной путь: запросы раздаются задачами пула, каждая делает блокирующий pread/pwrite
+inline void RunThreadPool(int fd, bool write, const Vector<Request>& requests, ThreadPool* pool) {
+    ParallelOptions options;
+    options.grain_size = 1;
+    options.pool = pool;
+    parallel_detail::ForChunks(requests.Size(), options, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const Request& request = requests[i];
+            if (write) {
+                io_detail::PWriteAll(fd, request.data, request.size, request.offset);
+            } else {
+                ReadRequest(fd, request);
+            }
+        }
+    });
+}
+
+// Читает или пишет size байт, разбивая их на запросы по chunk_bytes; при
+// чтении конец файла допустим после первых required байт.
+// io_uring используется, если доступен; иначе — пул потоков
+inline void RunChunked(int fd, bool write, char* data, size_t size, size_t required, off_t offset,
+                       const AsyncIoOptions& options) {
+    Vector<Request> requests = SplitRequests(data, size, required, offset, options.chunk_bytes,
+                                             std::max<size_t>(options.alignment, 1));
+    if (requests.Size() == 0) {
+        return;
+    }
+#if ADVANCED_VECTOR_HAS_IO_URING
+    if (options.use_io_uring) {
+        std::optional<IoUring> ring;
+        try {
+            const size_t depth = std::min<size_t>(std::clamp(options.queue_depth, 1u, MAX_QUEUE_DEPTH), requests.Size());
+            ring.emplace(static_cast<unsigned>(depth));
+        } catch (const std::system_error&) {
+            // Ядро без io_uring или запрет через seccomp: переходим на пул
+        }
+        // На ядрах до 5.6 кольцо создаётся, но чтение и запись в нём дают -EINVAL
+        if (ring && UringSupportsReadWrite(*ring)) {
+            RunUring(*ring, fd, write, requests);
+            return;
+        }
+    }
+#endif
+    RunThreadPool(fd, write, requests, options.pool);
+}
+
+// Промежуточный буфер из целых выровненных блоков не меньше size байт
+inline RawMemory<DirectIoBlock> AllocateDirectIoBuffer(size_t size) {
+    return RawMemory<DirectIoBlock>((size + sizeof(DirectIoBlock) - 1) / sizeof(DirectIoBlock));
+}
+
+}  // namespace async_io_detail
+
+// Асинхронно записывает содержимое v в fd начиная с offset. Вектор нельзя
+// изменять и разрушать, пока future не готов. Ошибки ввода-вывода
+// передаются через future как std::system_error, неверное выравнивание
+// сразу бросает std::invalid_argument
+template <typename T>
+std::future<void> AsyncStore(int fd, const Vector<T>& v, off_t offset = 0, AsyncIoOptions options = {}) {
+    static_assert(std::is_trivially_copyable_v<T>, "AsyncStore requires a trivially copyable type");
+    const size_t alignment = async_io_detail::CheckAlignment(options.alignment);
+    const char* data = reinterpret_cast<const char*>(v.begin());
+    const size_t size = v.Size() * sizeof(T);
+    if (offset % static_cast<off_t>(alignment) != 0 || size % alignment != 0) {
+        throw std::invalid_argument("AsyncStore: offset and size must be multiples of the alignment");
+    }
+    return std::async(std::launch::async, [fd, data, size, offset, alignment, options] {
+        if (alignment == 1) {
+            async_io_detail::RunChunked(fd, true, const_cast<char*>(data), size, size, offset, options);
+            return;
+        }
+        auto staging = async_io_detail::AllocateDirectIoBuffer(size);
+        char* aligned = reinterpret_cast<char*>(staging.GetAddress());
+        std::copy_n(data, size, aligned);
+        async_io_detail::RunChunked(fd, true, aligned, size, size, offset, options);
+    });
+}
+
+// Асинхронно читает count элементов из fd начиная с offset в новый вектор.
+// Без выравнивания данные читаются прямо в неинициализированный буфер
+// вектора, с выравниванием — через промежуточный буфер. Конец файла
+// раньше count элементов — ошибка std::system_error, как и сбой чтения
+template <typename T>
+std::future<Vector<T>> AsyncLoad(int fd, size_t count, off_t offset = 0, AsyncIoOptions options = {}) {
+    static_assert(std::is_trivially_copyable_v<T>, "AsyncLoad requires a trivially copyable type");
+    const size_t alignment = async_io_detail::CheckAlignment(options.alignment);
+    return std::async(std::launch::async, [fd, count, offset, alignment, options] {
+        const size_t bytes = count * sizeof(T);
+        Vector<T> result;
+        if (alignment == 1) {
+            result.AppendUninitialized(count, [&](T* dst) {
+                async_io_detail::RunChunked(fd, false, reinterpret_cast<char*>(dst), bytes, bytes, offset, options);
+                return count;
+            });
+            return result;
+        }
+        // Охват диапазона границами выравнивания; хвост за концом файла не читается
+        const off_t begin = offset / static_cast<off_t>(alignment) * static_cast<off_t>(alignment);
+        const auto head = static_cast<size_t>(offset - begin);
+        const size_t span = (head + bytes + alignment - 1) / alignment * alignment;
+        auto staging = async_io_detail::AllocateDirectIoBuffer(span);
+        char* aligned = reinterpret_cast<char*>(staging.GetAddress());
+        async_io_detail::RunChunked(fd, false, aligned, span, head + bytes, begin, options);
+        result.AppendUninitialized(count, [&](T* dst) {
+            std::copy_n(aligned + head, bytes, reinterpret_cast<char*>(dst));
+            return count;
+        });
+        return result;
+    });
+}
@@ -0,0 +1,476 @@
+#pragma once
+
+#include "vector.h"
+#include "parallel.h"
+#include "simd.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+// Способ суммирования в Dot, Asum и Nrm2
+enum class Summation {
+    // Несколько независимых сумм по дорожкам SIMD: быстро, ошибка растёт с длиной
+    FAST,
+    // Компенсированное суммирование Кэхэна в каждой дорожке
+    KAHAN,
+    // Попарное суммирование блоков: ошибка растёт как логарифм длины
+    PAIRWISE,
+};
+
+struct BlasOptions {
+    Summation summation = Summation::FAST;
+    // Верхняя граница набора инструкций; выше обнаруженного у процессора не поднимается
+    SimdLevel max_simd = SimdLevel::AVX512;
+    // Векторы короче обрабатываются в вызывающем потоке
+    size_t parallel_threshold = size_t{1} << 18;
+    // Элементов на задачу пула. От него зависит порядок суммирования,
+    // поэтому при одинаковых настройках результат воспроизводим
+    size_t grain_size = size_t{1} << 16;
+    ThreadPool* pool = nullptr;
+};
+
+// Ядра написаны на векторных расширениях GCC/Clang, см. simd.h
+namespace blas_detail {
+
+using simd_detail::Load;
+using simd_detail::Simd;
+using simd_detail::Store;
+
+inline constexpr size_t UNROLL = 4;
+inline constexpr size_t PAIRWISE_BLOCK = 512;
+
+enum class ReduceOp {
+    DOT,
+    ABS_SUM,
+    SQUARE_SUM,
+};
+
+template <typename V>
+ADVANCED_VECTOR_INLINE void Abs(V& v) noexcept {
+    v = v < V{} ? -v : v;
+}
+
+// Слагаемое суммы для позиции: x·y, |x| или (x·scale)²
+template <ReduceOp OP, typename V>
+ADVANCED_VECTOR_INLINE void Term(V& out, const V& x, const V& y, const V& scale) noexcept {
+    if constexpr (OP == ReduceOp::DOT) {
+        out = x * y;
+    } else if constexpr (OP == ReduceOp::ABS_SUM) {
+        out = x;
+        Abs(out);
+    } else {
+        out = x * scale;
+        out *= out;
+    }
+}
+
+template <typename V>
+ADVANCED_VECTOR_INLINE void KahanAdd(V& sum, V& compensation, const V& term) noexcept {
+    const V corrected = term - compensation;
+    const V next = sum + corrected;
+    compensation = (next - sum) - corrected;
+    sum = next;
+}
+
+template <typename T, size_t BYTES>
+ADVANCED_VECTOR_INLINE void AxpyKernel(T alpha, const T* x, T* y, size_t n) noexcept {
+    constexpr size_t WIDTH = BYTES / sizeof(T);
+    using V = Simd<T, BYTES>;
+    const V a = V{} + alpha;
+    size_t i = 0;
+    for (; i + WIDTH <= n; i += WIDTH) {
+        V xv;
+        V yv;
+        Load(xv, x + i);
+        Load(yv, y + i);
+        yv += a * xv;
+        Store(y + i, yv);
+    }
+    for (; i < n; ++i) {
+        y[i] += alpha * x[i];
+    }
+}
+
+template <typename T, size_t BYTES>
+ADVANCED_VECTOR_INLINE void ScaleKernel(T alpha, T* x, size_t n) noexcept {
+    constexpr size_t WIDTH = BYTES / sizeof(T);
+    using V = Simd<T, BYTES>;
+    const V a = V{} + alpha;
+    size_t i = 0;
+    for (; i + WIDTH <= n; i += WIDTH) {
+        V xv;
+        Load(xv, x + i);
+        xv *= a;
+        Store(x + i, xv);
+    }
+    for (; i < n; ++i) {
+        x[i] *= alpha;
+    }
+}
+
+// Сумма Term по [0, n) в UNROLL независимых регистрах, без компенсации или с ней
+template <typename T, size_t BYTES, ReduceOp OP, bool KAHAN>
+ADVANCED_VECTOR_INLINE T ReduceKernel(const T* x, const T* y, T scale, size_t n) noexcept {
+    using V = Simd<T, BYTES>;
+    constexpr size_t WIDTH = BYTES / sizeof(T);
+    const V scale_v = V{} + scale;
+    V sum[UNROLL] = {};
+    V compensation[UNROLL] = {};
+    size_t i = 0;
+    for (; i + UNROLL * WIDTH <= n; i += UNROLL * WIDTH) {
+        for (size_t k = 0; k < UNROLL; ++k) {
+            const size_t at = i + k * WIDTH;
+            V xv;
+            V yv = {};
+            Load(xv, x + at);
+            if constexpr (OP == ReduceOp::DOT) {
+                Load(yv, y + at);
+            }
+            V term;
+            Term<OP>(term, xv, yv, scale_v);
+            if constexpr (KAHAN) {
+                KahanAdd(sum[k], compensation[k], term);
+            } else {
+                sum[k] += term;
+            }
+        }
+    }
+    T total = 0;
+    T total_compensation = 0;
+    auto add = [&](T term) {
+        if constexpr (KAHAN) {
+            KahanAdd(total, total_compensation, term);
+        } else {
+            total += term;
+        }
+    };
+    for (size_t k = 0; k < UNROLL; ++k) {
+        for (size_t lane = 0; lane < WIDTH; ++lane) {
+            add(sum[k][lane]);
+            add(-compensation[k][lane]);
+        }
+    }
+    for (; i < n; ++i) {
+        T term;
+        Term<OP>(term, x[i], OP == ReduceOp::DOT ? y[i] : T{}, scale);
+        add(term);
+    }
+    return total;
+}
+
+// Наибольший модуль; NaN пропускаются
+template <typename T, size_t BYTES>
+ADVANCED_VECTOR_INLINE T AbsMaxKernel(const T* x, size_t n) noexcept {
+    using V = Simd<T, BYTES>;
+    constexpr size_t WIDTH = BYTES / sizeof(T);
+    V best = {};
+    size_t i = 0;
+    for (; i + WIDTH <= n; i += WIDTH) {
+        V value;
+        Load(value, x + i);
+        Abs(value);
+        best = value > best ? value : best;
+    }
+    T result = 0;
+    for (size_t lane = 0; lane < WIDTH; ++lane) {
+        result = best[lane] > result ? best[lane] : result;
+    }
+    for (; i < n; ++i) {
+        const T value = x[i] < 0 ? -x[i] : x[i];
+        result = value > result ? value : result;
+    }
+    return result;
+}
+
+// Точки входа для каждого набора инструкций. Ядра встраиваются в них
+// и компилируются под ширину регистров этого набора
+template <typename T>
+struct BaselineKernels {
+    static constexpr size_t BYTES = 16;
+
+    static void Axpy(T alpha, const T* x, T* y, size_t n) noexcept {
+        AxpyKernel<T, BYTES>(alpha, x, y, n);
+    }
+
+    static void Scale(T alpha, T* x, size_t n) noexcept {
+        ScaleKernel<T, BYTES>(alpha, x, n);
+    }
+
+    template <ReduceOp OP, bool KAHAN>
+    static T Reduce(const T* x, const T* y, T scale, size_t n) noexcept {
+        return ReduceKernel<T, BYTES, OP, KAHAN>(x, y, scale, n);
+    }
+
+    static T AbsMax(const T* x, size_t n) noexcept {
+        return AbsMaxKernel<T, BYTES>(x, n);
+    }
+};
+
+#if ADVANCED_VECTOR_X86_DISPATCH
+
+template <typename T>
+struct Avx2Kernels {
+    static constexpr size_t BYTES = 32;
+
+    ADVANCED_VECTOR_TARGET("avx2,fma") static void Axpy(T alpha, const T* x, T* y, size_t n) noexcept {
+        AxpyKernel<T, BYTES>(alpha, x, y, n);
+    }
+
+    ADVANCED_VECTOR_TARGET("avx2,fma") static void Scale(T alpha, T* x, size_t n) noexcept {
+        ScaleKernel<T, BYTES>(alpha, x, n);
+    }
+
+    template <ReduceOp OP, bool KAHAN>
+    ADVANCED_VECTOR_TARGET("avx2,fma") static T Reduce(const T* x, const T* y, T scale, size_t n) noexcept {
+        return ReduceKernel<T, BYTES, OP, KAHAN>(x, y, scale, n);
+    }
+
+    ADVANCED_VECTOR_TARGET("avx2,fma") static T AbsMax(const T* x, size_t n) noexcept {
+        return AbsMaxKernel<T, BYTES>(x, n);
+    }
+};
+
+template <typename T>
+struct Avx512Kernels {
+    static constexpr size_t BYTES = 64;
+
+    ADVANCED_VECTOR_TARGET("avx512f") static void Axpy(T alpha, const T* x, T* y, size_t n) noexcept {
+        AxpyKernel<T, BYTES>(alpha, x, y, n);
+    }
+
+    ADVANCED_VECTOR_TARGET("avx512f") static void Scale(T alpha, T* x, size_t n) noexcept {
+        ScaleKernel<T, BYTES>(alpha, x, n);
+    }
+
+    template <ReduceOp OP, bool KAHAN>
+    ADVANCED_VECTOR_TARGET("avx512f") static T Reduce(const T* x, const T* y, T scale, size_t n) noexcept {
+        return ReduceKernel<T, BYTES, OP, KAHAN>(x, y, scale, n);
+    }
+
+    ADVANCED_VECTOR_TARGET("avx512f") static T AbsMax(const T* x, size_t n) noexcept {
+        return AbsMaxKernel<T, BYTES>(x, n);
+    }
+};
+
+#endif  // ADVANCED_VECTOR_X86_DISPATCH
+
+// Указатели на ядра выбранного набора инструкций
+template <typename T>
+struct KernelTable {
+    using ReduceFn = T (*)(const T*, const T*, T, size_t) noexcept;
+
+    void (*axpy)(T, const T*, T*, size_t) noexcept;
+    void (*scale)(T, T*, size_t) noexcept;
+    // Индекс — ReduceOp, второй — включена ли компенсация Кэхэна
+    ReduceFn reduce[3][2];
+    T (*abs_max)(const T*, size_t) noexcept;
+};
+
+template <template <typename> typename Kernels, typename T>
+constexpr KernelTable<T> MakeTable() noexcept {
+    using K = Kernels<T>;
+    return KernelTable<T>{
+            &K::Axpy,
+            &K::Scale,
+            {
+                    {&K::template Reduce<ReduceOp::DOT, false>, &K::template Reduce<ReduceOp::DOT, true>},
+                    {&K::template Reduce<ReduceOp::ABS_SUM, false>, &K::template Reduce<ReduceOp::ABS_SUM, true>},
+                    {&K::template Reduce<ReduceOp::SQUARE_SUM, false>, &K::template Reduce<ReduceOp::SQUARE_SUM, true>},
+            },
+            &K::AbsMax,
+    };
+}
+
+}  // namespace blas_detail
+
+namespace blas_detail {
+
+template <typename T>
+const KernelTable<T>& Kernels(SimdLevel max_simd) noexcept {
+    static constexpr KernelTable<T> BASELINE = MakeTable<BaselineKernels, T>();
+#if ADVANCED_VECTOR_X86_DISPATCH
+    static constexpr KernelTable<T> AVX2 = MakeTable<Avx2Kernels, T>();
+    static constexpr KernelTable<T> AVX512 = MakeTable<Avx512Kernels, T>();
+    const SimdLevel level = std::min(DetectSimdLevel(), max_simd);
+    if (level == SimdLevel::AVX512) {
+        return AVX512;
+    }
+    if (level == SimdLevel::AVX2) {
+        return AVX2;
+    }
+#endif
+    return BASELINE;
+}
+
+template <typename T>
+inline constexpr bool IS_BLAS_TYPE = std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+// Сумма частичных сумм выбранным способом
+template <typename T>
+T Combine(const T* values, size_t n, Summation summation) noexcept {
+    if (summation == Summation::PAIRWISE && n > 2) {
+        return Combine(values, n / 2, summation) + Combine(values + n / 2, n - n / 2, summation);
+    }
+    T sum = 0;
+    T compensation = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (summation == Summation::KAHAN) {
+            KahanAdd(sum, compensation, values[i]);
+        } else {
+            sum += values[i];
+        }
+    }
+    return sum;
+}
+
+// Сумма на одном участке: попарная рекурсия до блоков PAIRWISE_BLOCK или одно ядро
+template <typename T>
+T ReduceRange(const KernelTable<T>& table, ReduceOp op, Summation summation, const T* x, const T* y, T scale,
+              size_t n) noexcept {
+    if (summation == Summation::PAIRWISE && n > PAIRWISE_BLOCK) {
+        const size_t half = n / 2;
+        return ReduceRange(table, op, summation, x, y, scale, half)
+             + ReduceRange(table, op, summation, x + half, y != nullptr ? y + half : nullptr, scale, n - half);
+    }
+    const bool kahan = summation == Summation::KAHAN;
+    return table.reduce[static_cast<size_t>(op)][kahan ? 1 : 0](x, y, scale, n);
+}
+
+inline ParallelOptions ChunkOptions(const BlasOptions& options) noexcept {
+    ParallelOptions parallel;
+    parallel.grain_size = std::max<size_t>(options.grain_size, 1);
+    parallel.pool = options.pool;
+    return parallel;
+}
+
+// Сумма по всему вектору; длинные векторы делятся на блоки по grain_size
+// между потоками, частичные суммы складываются тем же способом
+template <typename T>
+T Reduce(ReduceOp op, const T* x, const T* y, T scale, size_t n, const BlasOptions& options) {
+    const KernelTable<T>& table = Kernels<T>(options.max_simd);
+    if (n < options.parallel_threshold) {
+        return ReduceRange(table, op, options.summation, x, y, scale, n);
+    }
+    const ParallelOptions parallel = ChunkOptions(options);
+    Vector<T> partials((n + parallel.grain_size - 1) / parallel.grain_size);
+    parallel_detail::ForChunks(n, parallel, [&](size_t chunk, size_t begin, size_t end) {
+        partials[chunk] = ReduceRange(table, op, options.summation, x + begin, y != nullptr ? y + begin : nullptr,
+                                      scale, end - begin);
+    });
+    return Combine(partials.begin(), partials.Size(), options.summation);
+}
+
+// Применяет f(begin, end) к участкам вектора, параллельно для длинных векторов
+template <typename F>
+void ForRanges(size_t n, const BlasOptions& options, F&& f) {
+    if (n < options.parallel_threshold) {
+        f(size_t{0}, n);
+        return;
+    }
+    parallel_detail::ForChunks(n, ChunkOptions(options), [&f](size_t, size_t begin, size_t end) {
+        f(begin, end);
+    });
+}
+
+}  // namespace blas_detail
+
+// y += alpha * x
+template <typename T>
+void Axpy(T alpha, const Vector<T>& x, Vector<T>& y, const BlasOptions& options = {}) {
+    static_assert(blas_detail::IS_BLAS_TYPE<T>, "BLAS kernels support float and double");
+    assert(x.Size() == y.Size());
+    const auto axpy = blas_detail::Kernels<T>(options.max_simd).axpy;
+    const T* src = x.begin();
+    T* dst = y.begin();
+    blas_detail::ForRanges(x.Size(), options, [=](size_t begin, size_t end) {
+        axpy(alpha, src + begin, dst + begin, end - begin);
+    });
+}
+
+// x *= alpha
+template <typename T>
+void Scale(T alpha, Vector<T>& x, const BlasOptions& options = {}) {
+    static_assert(blas_detail::IS_BLAS_TYPE<T>, "BLAS kernels support float and double");
+    const auto scale = blas_detail::Kernels<T>(options.max_simd).scale;
+    T* data = x.begin();
+    blas_detail::ForRanges(x.Size(), options, [=](size_t begin, size_t end) {
+        scale(alpha, data + begin, end - begin);
+    });
+}
+
+// Скалярное произведение
+template <typename T>
+T Dot(const Vector<T>& x, const Vector<T>& y, const BlasOptions& options = {}) {
+    static_assert(blas_detail::IS_BLAS_TYPE<T>, "BLAS kernels support float and double");
+    assert(x.Size() == y.Size());
+    return blas_detail::Reduce<T>(blas_detail::ReduceOp::DOT, x.begin(), y.begin(), T{1}, x.Size(), options);
+}
+
+// Сумма модулей
+template <typename T>
+T Asum(const Vector<T>& x, const BlasOptions& options = {}) {
+    static_assert(blas_detail::IS_BLAS_TYPE<T>, "BLAS kernels support float and double");
+    return blas_detail::Reduce<T>(blas_detail::ReduceOp::ABS_SUM, x.begin(), nullptr, T{1}, x.Size(), options);
+}
+
+// Евклидова норма. Сначала считается обычная сумма квадратов; если она
+// переполнилась или ушла в область потери точности, проход повторяется
+// с масштабированием на степень двойки по наибольшему модулю
+template <typename T>
+T Nrm2(const Vector<T>& x, const BlasOptions& options = {}) {
+    static_assert(blas_detail::IS_BLAS_TYPE<T>, "BLAS kernels support float and double");
+    using Limits = std::numeric_limits<T>;
+    const T squares = blas_detail::Reduce<T>(blas_detail::ReduceOp::SQUARE_SUM, x.begin(), nullptr, T{1}, x.Size(),
+                                             options);
+    if (std::isfinite(squares) && squares >= Limits::min() / Limits::epsilon()) {
+        return std::sqrt(squares);
+    }
+    const T largest = blas_detail::Kernels<T>(options.max_simd).abs_max(x.begin(), x.Size());
+    if (largest == 0 || !std::isfinite(largest)) {
+        return std::isnan(squares) ? squares : largest;
+    }
+    const T scale = std::ldexp(T{1}, std::min(-std::ilogb(largest), Limits::max_exponent - 1));
+    const T scaled = blas_detail::Reduce<T>(blas_detail::ReduceOp::SQUARE_SUM, x.begin(), nullptr, scale, x.Size(),
+                                            options);
+    return std::sqrt(scaled) / scale;
+}
+
+// Индекс первого элемента с наибольшим модулем. NaN не учитываются;
+// у пустого вектора и вектора из одних NaN возвращает 0
+template <typename T>
+size_t Iamax(const Vector<T>& x, const BlasOptions& options = {}) {
+    static_assert(blas_detail::IS_BLAS_TYPE<T>, "BLAS kernels support float and double");
+    const auto abs_max = blas_detail::Kernels<T>(options.max_simd).abs_max;
+    const T* data = x.begin();
+    const size_t n = x.Size();
+    // Сначала наибольший модуль по участкам, затем поиск его первого вхождения
+    // только в первом участке, где он встретился
+    size_t grain = n;
+    Vector<T> partials;
+    if (n >= options.parallel_threshold) {
+        grain = std::max<size_t>(options.grain_size, 1);
+        partials.Resize((n + grain - 1) / grain);
+        parallel_detail::ForChunks(n, blas_detail::ChunkOptions(options), [&](size_t chunk, size_t begin, size_t end) {
+            partials[chunk] = abs_max(data + begin, end - begin);
+        });
+    } else if (n != 0) {
+        partials.PushBack(abs_max(data, n));
+    }
+    T largest = 0;
+    size_t chunk = 0;
+    for (size_t i = 0; i < partials.Size(); ++i) {
+        if (partials[i] > largest) {
+            largest = partials[i];
+            chunk = i;
+        }
+    }
+    const size_t end = std::min(n, (chunk + 1) * grain);
+    for (size_t i = chunk * grain; i < end; ++i) {
+        if (std::abs(data[i]) == largest) {
+            return i;
+        }
+    }
+    return 0;
+}
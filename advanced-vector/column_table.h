@@ -0,0 +1,179 @@
+#pragma once
+
+#include "vector.h"
+#include "span.h"
+
+#include <cstdint>
+#include <tuple>
+#include <utility>
+
+// Последовательность номеров выбранных строк. Фильтры над столбцами
+// сужают выборку, не трогая остальные столбцы
+using SelectionVector = Vector<uint32_t>;
+
+// Невладеющее представление одного столбца, ограниченное выборкой строк.
+// Без выборки обходит все строки подряд
+template <typename T>
+class ColumnView {
+public:
+    ColumnView(const Vector<T>& column, const SelectionVector* selection) noexcept
+            : column_(&column)
+            , selection_(selection) {
+    }
+
+    size_t Size() const noexcept {
+        return selection_ != nullptr ? selection_->Size() : column_->Size();
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return (*column_)[selection_ != nullptr ? (*selection_)[index] : index];
+    }
+
+    // Номер строки таблицы для index-го элемента представления
+    uint32_t Row(size_t index) const noexcept {
+        return selection_ != nullptr ? (*selection_)[index] : static_cast<uint32_t>(index);
+    }
+
+private:
+    const Vector<T>* column_;
+    const SelectionVector* selection_;
+};
+
+// Колоночная таблица: по одному Vector на столбец и общий счётчик строк.
+// Сканирование одного столбца читает только его данные
+template <typename... Cols>
+class ColumnTable {
+public:
+    static constexpr size_t COLUMN_COUNT = sizeof...(Cols);
+
+    template <size_t I>
+    using ColumnType = std::tuple_element_t<I, std::tuple<Cols...>>;
+
+    // Представление выбранных столбцов: ссылки на них и общая выборка, без копирования данных
+    template <size_t... Is>
+    class Projection {
+    public:
+        Projection(const ColumnTable& table, const SelectionVector* selection) noexcept
+                : table_(&table)
+                , selection_(selection) {
+        }
+
+        size_t Size() const noexcept {
+            return selection_ != nullptr ? selection_->Size() : table_->Size();
+        }
+
+        // Значения строки index представления для выбранных столбцов
+        std::tuple<const ColumnType<Is>&...> operator[](size_t index) const noexcept {
+            const size_t row = selection_ != nullptr ? (*selection_)[index] : index;
+            return std::tuple<const ColumnType<Is>&...>(table_->template Column<Is>()[row]...);
+        }
+
+        template <size_t J>
+        ColumnView<ColumnType<J>> Column() const noexcept {
+            static_assert(((J == Is) || ...), "Column is not part of the projection");
+            return ColumnView<ColumnType<J>>(table_->template Column<J>(), selection_);
+        }
+
+    private:
+        const ColumnTable* table_;
+        const SelectionVector* selection_;
+    };
+
+    ColumnTable() = default;
+
+    void Reserve(size_t rows) {
+        std::apply([rows](auto&... columns) {
+            (columns.Reserve(rows), ...);
+        }, columns_);
+    }
+
+    // Добавляет строку. При исключении уже добавленные в столбцы значения удаляются
+    template <typename... Args>
+    void AppendRow(Args&&... values) {
+        static_assert(sizeof...(Args) == COLUMN_COUNT, "AppendRow expects one value per column");
+        AppendFrom<0>(std::forward_as_tuple(std::forward<Args>(values)...));
+        ++size_;
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    template <size_t I>
+    const Vector<ColumnType<I>>& Column() const noexcept {
+        return std::get<I>(columns_);
+    }
+
+    // Значения столбца можно менять на месте, но не его длину: строки
+    // добавляются только через AppendRow, чтобы столбцы не разошлись с Size()
+    template <size_t I>
+    Span<ColumnType<I>> Column() noexcept {
+        return std::get<I>(columns_).AsSpan();
+    }
+
+    // Оставляет в selection только строки, для которых pred(значение столбца I) истинно.
+    // Пустой указатель selection означает «все строки»; результат дописывается в out
+    template <size_t I, typename Pred>
+    void Filter(Pred&& pred, const SelectionVector* selection, SelectionVector& out) const {
+        const auto& column = Column<I>();
+        if (selection == nullptr) {
+            for (size_t row = 0; row < size_; ++row) {
+                if (pred(column[row])) {
+                    out.PushBack(static_cast<uint32_t>(row));
+                }
+            }
+        } else {
+            for (uint32_t row : *selection) {
+                if (pred(column[row])) {
+                    out.PushBack(row);
+                }
+            }
+        }
+    }
+
+    // Сканирует столбец I пакетами до batch_size значений: f(const T* values, size_t count,
+    // const uint32_t* rows), где rows — номера строк пакета или nullptr для подряд идущих
+    template <size_t I, typename F>
+    void Scan(size_t batch_size, F&& f, const SelectionVector* selection = nullptr) const {
+        assert(batch_size != 0);
+        const auto& column = Column<I>();
+        if (selection == nullptr) {
+            for (size_t begin = 0; begin < size_; begin += batch_size) {
+                f(column.begin() + begin, std::min(batch_size, size_ - begin), static_cast<const uint32_t*>(nullptr));
+            }
+            return;
+        }
+        Vector<ColumnType<I>> batch;
+        batch.Reserve(batch_size);
+        for (size_t begin = 0; begin < selection->Size(); begin += batch_size) {
+            const size_t count = std::min(batch_size, selection->Size() - begin);
+            batch.Clear();
+            for (size_t i = 0; i < count; ++i) {
+                batch.PushBack(column[(*selection)[begin + i]]);
+            }
+            f(batch.begin(), count, selection->begin() + begin);
+        }
+    }
+
+    template <size_t... Is>
+    Projection<Is...> Project(const SelectionVector* selection = nullptr) const noexcept {
+        return Projection<Is...>(*this, selection);
+    }
+
+private:
+    template <size_t I, typename Tuple>
+    void AppendFrom(Tuple&& values) {
+        if constexpr (I < COLUMN_COUNT) {
+            std::get<I>(columns_).PushBack(std::get<I>(std::forward<Tuple>(values)));
+            try {
+                AppendFrom<I + 1>(std::forward<Tuple>(values));
+            } catch (...) {
+                std::get<I>(columns_).PopBack();
+                throw;
+            }
+        }
+    }
+
+    std::tuple<Vector<Cols>...> columns_;
+    size_t size_ = 0;
+};
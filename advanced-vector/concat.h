@@ -0,0 +1,105 @@
+#pragma once
+
+#include "vector.h"
+
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace concat_detail {
+
+template <typename V>
+struct IsVector : std::false_type {};
+
+template <typename T>
+struct IsVector<Vector<T>> : std::true_type {};
+
+template <typename V>
+inline constexpr bool IS_VECTOR = IsVector<std::remove_cv_t<std::remove_reference_t<V>>>::value;
+
+// Дописывает элементы source в result, ёмкость которого уже достаточна.
+// Из rvalue-источника элементы перемещаются, из lvalue — копируются
+template <typename T, typename Source>
+void AppendAll(Vector<T>& result, Source&& source) {
+    assert(result.Capacity() - result.Size() >= source.Size());
+    const size_t count = source.Size();
+    if (count == 0) {
+        return;
+    }
+    result.AppendUninitialized(count, [&source, count](T* dst) {
+        if constexpr (std::is_rvalue_reference_v<Source&&> && !std::is_const_v<std::remove_reference_t<Source>>) {
+            std::uninitialized_move_n(source.begin(), count, dst);
+        } else {
+            std::uninitialized_copy_n(source.begin(), count, dst);
+        }
+        return count;
+    });
+}
+
+// Начальный вектор результата: буфер первого операнда, если он отдан по
+// rvalue и в нём хватает места на всё, иначе новый буфер точно под total
+template <typename T, typename First>
+Vector<T> StartWith(First&& first, size_t total) {
+    if constexpr (std::is_rvalue_reference_v<First&&> && !std::is_const_v<std::remove_reference_t<First>>) {
+        if (first.Capacity() >= total) {
+            return Vector<T>(std::move(first));
+        }
+    }
+    Vector<T> result;
+    result.Reserve(total);
+    AppendAll(result, std::forward<First>(first));
+    return result;
+}
+
+}  // namespace concat_detail
+
+// Склеивает векторы с единственным выделением памяти под суммарный размер.
+// Элементы операндов, переданных по rvalue, перемещаются; если у первого
+// операнда, отданного по rvalue, хватает запаса ёмкости, результат забирает
+// его буфер и вовсе не выделяет памяти
+template <typename First, typename Second, typename... Rest,
+          typename = std::enable_if_t<concat_detail::IS_VECTOR<First> && concat_detail::IS_VECTOR<Second>
+                                      && (concat_detail::IS_VECTOR<Rest> && ...)>>
+auto Concat(First&& first, Second&& second, Rest&&... rest) {
+    using Result = std::remove_cv_t<std::remove_reference_t<First>>;
+    static_assert(std::is_same_v<Result, std::remove_cv_t<std::remove_reference_t<Second>>>
+                          && (std::is_same_v<Result, std::remove_cv_t<std::remove_reference_t<Rest>>> && ...),
+                  "Concat requires vectors of the same type");
+    using T = std::remove_pointer_t<decltype(std::declval<Result&>().begin())>;
+    const size_t total = first.Size() + second.Size() + (size_t{0} + ... + rest.Size());
+    Vector<T> result = concat_detail::StartWith<T>(std::forward<First>(first), total);
+    concat_detail::AppendAll(result, std::forward<Second>(second));
+    (concat_detail::AppendAll(result, std::forward<Rest>(rest)), ...);
+    return result;
+}
+
+// То же для диапазона векторов, например Vector<Vector<T>> с частичными
+// результатами. Из диапазона, переданного по rvalue, элементы перемещаются
+template <typename Range, typename = std::enable_if_t<concat_detail::IS_VECTOR<decltype(*std::begin(std::declval<Range&>()))>>>
+auto Concat(Range&& vectors) {
+    using Element = std::remove_cv_t<std::remove_reference_t<decltype(*std::begin(vectors))>>;
+    using T = std::remove_pointer_t<decltype(std::declval<Element&>().begin())>;
+
+    size_t total = 0;
+    for (const auto& v : vectors) {
+        total += v.Size();
+    }
+    auto it = std::begin(vectors);
+    const auto last = std::end(vectors);
+    if (it == last) {
+        return Vector<T>();
+    }
+    auto forward = [](auto& v) -> decltype(auto) {
+        if constexpr (std::is_lvalue_reference_v<Range>) {
+            return std::as_const(v);
+        } else {
+            return std::move(v);
+        }
+    };
+    Vector<T> result = concat_detail::StartWith<T>(forward(*it), total);
+    for (++it; it != last; ++it) {
+        concat_detail::AppendAll(result, forward(*it));
+    }
+    return result;
+}
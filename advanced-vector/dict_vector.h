@@ -0,0 +1,165 @@
+#pragma once
+
+#include "vector.h"
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <type_traits>
+#include <unordered_map>
+
+// Вектор со словарным кодированием для столбцов с небольшим числом различных
+// значений. Каждое уникальное значение хранится один раз, строки хранят коды.
+// Ширина кода (8, 16 или 32 бита) растёт по мере роста словаря
+template <typename T, typename Hash = std::hash<T>>
+class DictVector {
+public:
+    DictVector() = default;
+
+    void PushBack(const T& value) {
+        const uint32_t code = Intern(value);
+        switch (code_width_) {
+            case 1:
+                codes8_.PushBack(static_cast<uint8_t>(code));
+                break;
+            case 2:
+                codes16_.PushBack(static_cast<uint16_t>(code));
+                break;
+            default:
+                codes32_.PushBack(code);
+        }
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return dictionary_[Code(index)];
+    }
+
+    uint32_t Code(size_t index) const noexcept {
+        return VisitCodes([index](const auto& codes) {
+            return static_cast<uint32_t>(codes[index]);
+        });
+    }
+
+    // Код значения, если оно есть в словаре
+    std::optional<uint32_t> FindCode(const T& value) const {
+        const auto it = index_.find(value);
+        if (it == index_.end()) {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    // Дописывает в rows номера строк, равных value. Значение ищется в словаре
+    // один раз, дальше сравниваются только коды
+    void FilterEqual(const T& value, Vector<uint32_t>& rows) const {
+        const std::optional<uint32_t> code = FindCode(value);
+        if (!code) {
+            return;
+        }
+        VisitCodes([&rows, code = *code](const auto& codes) {
+            using Code = std::decay_t<decltype(codes[0])>;
+            const auto target = static_cast<Code>(code);
+            for (size_t i = 0; i < codes.Size(); ++i) {
+                if (codes[i] == target) {
+                    rows.PushBack(static_cast<uint32_t>(i));
+                }
+            }
+        });
+    }
+
+    // Дописывает значения всех строк в конец out одной аллокацией
+    void Decode(Vector<T>& out) const {
+        out.AppendUninitialized(Size(), [this](T* dst) {
+            return VisitCodes([this, dst](const auto& codes) {
+                size_t i = 0;
+                try {
+                    for (; i < codes.Size(); ++i) {
+                        new (dst + i) T(dictionary_[codes[i]]);
+                    }
+                } catch (...) {
+                    std::destroy_n(dst, i);
+                    throw;
+                }
+                return codes.Size();
+            });
+        });
+    }
+
+    size_t Size() const noexcept {
+        return VisitCodes([](const auto& codes) {
+            return codes.Size();
+        });
+    }
+
+    size_t Cardinality() const noexcept {
+        return dictionary_.Size();
+    }
+
+    const Vector<T>& Dictionary() const noexcept {
+        return dictionary_;
+    }
+
+    // Ширина кода в байтах
+    unsigned CodeWidth() const noexcept {
+        return code_width_;
+    }
+
+private:
+    template <typename F>
+    decltype(auto) VisitCodes(F&& f) const {
+        switch (code_width_) {
+            case 1:
+                return f(codes8_);
+            case 2:
+                return f(codes16_);
+            default:
+                return f(codes32_);
+        }
+    }
+
+    uint32_t Intern(const T& value) {
+        if (const auto it = index_.find(value); it != index_.end()) {
+            return it->second;
+        }
+        const auto code = static_cast<uint32_t>(dictionary_.Size());
+        if (code > std::numeric_limits<uint16_t>::max() && code_width_ < 4) {
+            Widen(codes32_);
+            code_width_ = 4;
+        } else if (code > std::numeric_limits<uint8_t>::max() && code_width_ < 2) {
+            Widen(codes16_);
+            code_width_ = 2;
+        }
+        dictionary_.PushBack(value);
+        try {
+            index_.emplace(value, code);
+        } catch (...) {
+            dictionary_.PopBack();
+            throw;
+        }
+        return code;
+    }
+
+    // Переписывает текущие коды в более широкий вектор
+    template <typename Code>
+    void Widen(Vector<Code>& wider) {
+        wider.Clear();
+        VisitCodes([&wider](const auto& codes) {
+            wider.Reserve(codes.Size());
+            for (size_t i = 0; i < codes.Size(); ++i) {
+                wider.PushBack(static_cast<Code>(codes[i]));
+            }
+        });
+        codes8_ = Vector<uint8_t>{};
+        if constexpr (!std::is_same_v<Code, uint16_t>) {
+            codes16_ = Vector<uint16_t>{};
+        }
+    }
+
+    Vector<T> dictionary_;
+    std::unordered_map<T, uint32_t, Hash> index_;
+    unsigned code_width_ = 1;
+    Vector<uint8_t> codes8_;
+    Vector<uint16_t> codes16_;
+    Vector<uint32_t> codes32_;
+};
@@ -0,0 +1,349 @@
+#pragma once
+
+#include "vector.h"
+#include "file_io.h"
+#include "sort.h"
+#include "vector_io.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+
+namespace external_sort_detail {
+
+// Отсортированный участок во временном файле
+struct Run {
+    off_t offset;
+    size_t count;
+};
+
+// Меньшие блоки превратили бы слияние в поток мелких pread; если бюджета
+// на все участки не хватает, они сливаются в несколько проходов
+inline constexpr size_t MIN_BLOCK_BYTES = size_t{64} << 10;
+
+// Один фоновый поток на всё слияние: запросы на чтение блоков выполняются
+// по очереди, вместо отдельного потока на каждый блок
+class ReadAheadThread {
+public:
+    ReadAheadThread()
+            : thread_([this] {
+                Loop();
+            }) {
+    }
+
+    ReadAheadThread(const ReadAheadThread&) = delete;
+    ReadAheadThread& operator=(const ReadAheadThread&) = delete;
+
+    // Поток дочитывает уже поставленные запросы: их буферы ещё ждут данных
+    ~ReadAheadThread() {
+        {
+            std::lock_guard guard(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        thread_.join();
+    }
+
+    // Ставит в очередь чтение size байт по смещению offset; future
+    // завершится, когда буфер заполнен, или передаст ошибку чтения
+    std::future<void> Read(int fd, void* buffer, size_t size, off_t offset) {
+        Request request{fd, buffer, size, offset, {}};
+        std::future<void> done = request.done.get_future();
+        {
+            std::lock_guard guard(mutex_);
+            requests_.push_back(std::move(request));
+        }
+        wake_.notify_one();
+        return done;
+    }
+
+private:
+    struct Request {
+        int fd = -1;
+        void* buffer = nullptr;
+        size_t size = 0;
+        off_t offset = 0;
+        std::promise<void> done;
+    };
+
+    void Loop() {
+        for (;;) {
+            Request request;
+            {
+                std::unique_lock lock(mutex_);
+                wake_.wait(lock, [this] {
+                    return stop_ || !requests_.empty();
+                });
+                if (requests_.empty()) {
+                    return;
+                }
+                request = std::move(requests_.front());
+                requests_.pop_front();
+            }
+            try {
+                io_detail::PReadAll(request.fd, request.buffer, request.size, request.offset);
+                request.done.set_value();
+            } catch (...) {
+                request.done.set_exception(std::current_exception());
+            }
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<Request> requests_;
+    bool stop_ = false;
+    std::thread thread_;
+};
+
+// Последовательное чтение участка с упреждением: пока слияние потребляет
+// текущий буфер, следующий блок уже читается в фоне
+template <typename T>
+class RunReader {
+public:
+    RunReader(ReadAheadThread& read_ahead, int fd, Run run, size_t block_size)
+            : read_ahead_(read_ahead)
+            , fd_(fd)
+            , next_offset_(run.offset)
+            , remaining_(run.count)
+            , current_(block_size)
+            , next_(block_size) {
+        StartRead();
+        Advance();
+    }
+
+    RunReader(const RunReader&) = delete;
+    RunReader& operator=(const RunReader&) = delete;
+
+    ~RunReader() {
+        if (pending_.valid()) {
+            pending_.wait();
+        }
+    }
+
+    bool Exhausted() const noexcept {
+        return position_ == available_;
+    }
+
+    const T& Head() const noexcept {
+        return current_[position_];
+    }
+
+    void Pop() {
+        if (++position_ == available_) {
+            Advance();
+        }
+    }
+
+private:
+    void StartRead() {
+        const size_t count = std::min(remaining_, next_.Capacity());
+        if (count == 0) {
+            next_count_ = 0;
+            return;
+        }
+        remaining_ -= count;
+        const off_t offset = next_offset_;
+        next_offset_ += static_cast<off_t>(count * sizeof(T));
+        next_count_ = count;
+        pending_ = read_ahead_.Read(fd_, next_.GetAddress(), count * sizeof(T), offset);
+    }
+
+    // Дожидается блока, прочитанного в фоне, делает его текущим и запускает чтение следующего
+    void Advance() {
+        if (pending_.valid()) {
+            pending_.get();
+        }
+        current_.Swap(next_);
+        available_ = next_count_;
+        position_ = 0;
+        StartRead();
+    }
+
+    ReadAheadThread& read_ahead_;
+    int fd_;
+    off_t next_offset_;
+    size_t remaining_;
+    RawMemory<T> current_;
+    RawMemory<T> next_;
+    size_t next_count_ = 0;
+    size_t available_ = 0;
+    size_t position_ = 0;
+    std::future<void> pending_;
+};
+
+// Дерево проигравших для k-путевого слияния: во внутренних узлах хранятся
+// проигравшие, победитель — в корне. Замена победителя стоит log2(k) сравнений
+class LoserTree {
+public:
+    // less(a, b) — должен ли источник a идти раньше источника b
+    template <typename Less>
+    LoserTree(size_t k, Less&& less)
+            : tree_(k) {
+        if (k == 1) {
+            tree_[0] = 0;
+            return;
+        }
+        Vector<size_t> winners(2 * k);
+        for (size_t i = 0; i < k; ++i) {
+            winners[k + i] = i;
+        }
+        for (size_t node = k - 1; node >= 1; --node) {
+            size_t a = winners[2 * node];
+            size_t b = winners[2 * node + 1];
+            if (less(b, a)) {
+                std::swap(a, b);
+            }
+            winners[node] = a;
+            tree_[node] = b;
+        }
+        tree_[0] = winners[1];
+    }
+
+    size_t Winner() const noexcept {
+        return tree_[0];
+    }
+
+    // Переигрывает путь от листа победителя после изменения его головы
+    template <typename Less>
+    void Replay(Less&& less) {
+        size_t winner = tree_[0];
+        for (size_t node = (tree_.Size() + winner) / 2; node >= 1; node /= 2) {
+            if (less(tree_[node], winner)) {
+                std::swap(tree_[node], winner);
+            }
+        }
+        tree_[0] = winner;
+    }
+
+private:
+    Vector<size_t> tree_;
+};
+
+// Сливает count участков файла fd деревом проигравших. Результат отдаётся
+// в flush(data, n) блоками по block_size записей
+template <typename T, typename Compare, typename Flush>
+void MergeRuns(ReadAheadThread& read_ahead, int fd, const Run* runs, size_t count, size_t block_size,
+               Compare& comp, Flush&& flush) {
+    Vector<std::unique_ptr<RunReader<T>>> readers;
+    readers.Reserve(count);
+    size_t total = 0;
+    for (size_t i = 0; i < count; ++i) {
+        readers.PushBack(std::make_unique<RunReader<T>>(read_ahead, fd, runs[i], block_size));
+        total += runs[i].count;
+    }
+    // Исчерпанные участки считаются больше любых; равные ключи упорядочиваются по номеру участка
+    auto less = [&readers, &comp](size_t a, size_t b) {
+        if (readers[a]->Exhausted() || readers[b]->Exhausted()) {
+            return !readers[a]->Exhausted() && (readers[b]->Exhausted() || a < b);
+        }
+        if (comp(readers[a]->Head(), readers[b]->Head())) {
+            return true;
+        }
+        return !comp(readers[b]->Head(), readers[a]->Head()) && a < b;
+    };
+    LoserTree tree(readers.Size(), less);
+
+    Vector<T> output;
+    output.Reserve(block_size);
+    for (size_t written = 0; written < total; ++written) {
+        RunReader<T>& reader = *readers[tree.Winner()];
+        output.PushBack(reader.Head());
+        reader.Pop();
+        tree.Replay(less);
+        if (output.Size() == block_size) {
+            flush(output.begin(), output.Size());
+            output.Clear();
+        }
+    }
+    flush(output.begin(), output.Size());
+}
+
+}  // namespace external_sort_detail
+
+// Внешняя сортировка записей фиксированного размера из input_fd в output_fd.
+// Вход читается блоками по memory_budget байт, каждый блок сортируется в памяти
+// и записывается во временный файл как отсортированный участок, после чего
+// участки сливаются деревом проигравших с упреждающим чтением в одном фоновом
+// потоке — за один проход или, если участков слишком много, за несколько.
+// Возвращает число записей; бросает std::invalid_argument, если размер входа
+// не кратен sizeof(T), и std::system_error при ошибках ввода-вывода
+template <typename T, typename Compare = std::less<>>
+size_t ExternalSort(int input_fd, int output_fd, size_t memory_budget, Compare comp = {}) {
+    static_assert(std::is_trivially_copyable_v<T>, "ExternalSort requires a trivially copyable type");
+    using namespace external_sort_detail;
+    const size_t chunk_size = std::max<size_t>(memory_budget / sizeof(T), 1);
+
+    auto sort_chunk = [&comp](Vector<T>& chunk) {
+        if constexpr (std::is_same_v<Compare, std::less<>>) {
+            Sort(chunk);
+        } else {
+            Sort(chunk, comp);
+        }
+    };
+
+    TempFile runs_file;
+    Vector<Run> runs;
+    off_t runs_size = 0;
+    size_t total = 0;
+    {
+        Vector<T> chunk;
+        chunk.Reserve(chunk_size);
+        for (;;) {
+            chunk.Clear();
+            if (ReadAppend(input_fd, chunk, chunk_size * sizeof(T)) == 0) {
+                break;
+            }
+            sort_chunk(chunk);
+            total += chunk.Size();
+            if (runs.Size() == 0 && chunk.Size() < chunk_size) {
+                // Весь вход поместился в память: слияние не нужно
+                io_detail::WriteAll(output_fd, chunk.begin(), chunk.Size() * sizeof(T));
+                return total;
+            }
+            io_detail::PWriteAll(runs_file.Fd(), chunk.begin(), chunk.Size() * sizeof(T), runs_size);
+            runs.PushBack(Run{runs_size, chunk.Size()});
+            runs_size += static_cast<off_t>(chunk.Size() * sizeof(T));
+        }
+    }
+    if (runs.Size() == 0) {
+        return 0;
+    }
+
+    // Бюджет делится между входными участками (по два буфера) и выходным
+    // буфером, но блок не меньше MIN_BLOCK_BYTES (или пятой части бюджета,
+    // если он совсем мал). Если участков больше, чем позволяет бюджет, они
+    // сначала сливаются группами по fan_in в более длинные
+    const size_t min_block = std::max<size_t>(std::min(MIN_BLOCK_BYTES, memory_budget / 5) / sizeof(T), 1);
+    const size_t fan_in = std::max<size_t>((chunk_size / min_block - 1) / 2, 2);
+    const size_t block_size = std::max(chunk_size / (2 * std::min(runs.Size(), fan_in) + 1), min_block);
+    ReadAheadThread read_ahead;
+    TempFile merged_file;
+    while (runs.Size() > fan_in) {
+        Vector<Run> merged;
+        off_t merged_size = 0;
+        for (size_t first = 0; first < runs.Size(); first += fan_in) {
+            const size_t count = std::min(fan_in, runs.Size() - first);
+            const off_t start = merged_size;
+            MergeRuns<T>(read_ahead, runs_file.Fd(), runs.begin() + first, count, block_size, comp,
+                         [&merged_file, &merged_size](const T* data, size_t n) {
+                             io_detail::PWriteAll(merged_file.Fd(), data, n * sizeof(T), merged_size);
+                             merged_size += static_cast<off_t>(n * sizeof(T));
+                         });
+            merged.PushBack(Run{start, static_cast<size_t>(merged_size - start) / sizeof(T)});
+        }
+        std::swap(runs_file, merged_file);
+        runs = std::move(merged);
+    }
+    MergeRuns<T>(read_ahead, runs_file.Fd(), runs.begin(), runs.Size(), block_size, comp,
+                 [output_fd](const T* data, size_t n) {
+                     io_detail::WriteAll(output_fd, data, n * sizeof(T));
+                 });
+    return total;
+}
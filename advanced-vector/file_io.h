@@ -0,0 +1,164 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <system_error>
+#include <utility>
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+// Вспомогательные функции ввода-вывода поверх файловых дескрипторов POSIX.
+// Ошибки сообщаются исключением std::system_error с кодом errno
+namespace io_detail {
+
+[[noreturn]] inline void ThrowErrno(const char* what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+// Записывает size байт целиком начиная с offset, повторяя при неполной записи
+inline void PWriteAll(int fd, const void* data, size_t size, off_t offset) {
+    const char* ptr = static_cast<const char*>(data);
+    while (size != 0) {
+        const ssize_t written = ::pwrite(fd, ptr, size, offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ThrowErrno("pwrite");
+        }
+        ptr += written;
+        size -= static_cast<size_t>(written);
+        offset += written;
+    }
+}
+
+// Читает ровно size байт начиная с offset; конец файла раньше времени — ошибка
+inline void PReadAll(int fd, void* data, size_t size, off_t offset) {
+    char* ptr = static_cast<char*>(data);
+    while (size != 0) {
+        const ssize_t got = ::pread(fd, ptr, size, offset);
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ThrowErrno("pread");
+        }
+        if (got == 0) {
+            throw std::system_error(std::make_error_code(std::errc::io_error), "pread: unexpected end of file");
+        }
+        ptr += got;
+        size -= static_cast<size_t>(got);
+        offset += got;
+    }
+}
+
+// Читает до size байт, повторяя при неполном чтении, пока не встретит конец файла.
+// Возвращает число прочитанных байт
+inline size_t ReadFull(int fd, void* data, size_t size) {
+    char* ptr = static_cast<char*>(data);
+    size_t total = 0;
+    while (total < size) {
+        const ssize_t got = ::read(fd, ptr + total, size - total);
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ThrowErrno("read");
+        }
+        if (got == 0) {
+            break;
+        }
+        total += static_cast<size_t>(got);
+    }
+    return total;
+}
+
+// Записывает size байт целиком в текущую позицию файла
+inline void WriteAll(int fd, const void* data, size_t size) {
+    const char* ptr = static_cast<const char*>(data);
+    while (size != 0) {
+        const ssize_t written = ::write(fd, ptr, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ThrowErrno("write");
+        }
+        ptr += written;
+        size -= static_cast<size_t>(written);
+    }
+}
+
+// Не больше, чем принимает writev в Linux (UIO_MAXIOV)
+inline constexpr size_t MAX_IOVECS = 1024;
+
+// Записывает все сегменты iov целиком через writev, порциями до MAX_IOVECS.
+// После неполной записи сдвигает начало текущего сегмента и продолжает
+// с того же места. Массив iov при этом изменяется
+inline void WriteVAll(int fd, iovec* iov, size_t count) {
+    while (count != 0) {
+        if (iov->iov_len == 0) {
+            ++iov;
+            --count;
+            continue;
+        }
+        const ssize_t written = ::writev(fd, iov, static_cast<int>(std::min(count, MAX_IOVECS)));
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ThrowErrno("writev");
+        }
+        auto left = static_cast<size_t>(written);
+        while (count != 0 && left >= iov->iov_len) {
+            left -= iov->iov_len;
+            ++iov;
+            --count;
+        }
+        if (left != 0) {
+            iov->iov_base = static_cast<char*>(iov->iov_base) + left;
+            iov->iov_len -= left;
+        }
+    }
+}
+
+}  // namespace io_detail
+
+// Анонимный временный файл, удаляемый системой при закрытии
+class TempFile {
+public:
+    TempFile()
+            : file_(std::tmpfile()) {
+        if (file_ == nullptr) {
+            io_detail::ThrowErrno("tmpfile");
+        }
+    }
+
+    TempFile(const TempFile&) = delete;
+    TempFile& operator=(const TempFile&) = delete;
+
+    TempFile(TempFile&& other) noexcept
+            : file_(std::exchange(other.file_, nullptr)) {
+    }
+
+    TempFile& operator=(TempFile&& rhs) noexcept {
+        std::swap(file_, rhs.file_);
+        return *this;
+    }
+
+    ~TempFile() {
+        if (file_ != nullptr) {
+            std::fclose(file_);
+        }
+    }
+
+    int Fd() const noexcept {
+        return fileno(file_);
+    }
+
+private:
+    std::FILE* file_;
+};
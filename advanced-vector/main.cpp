@@ -1,11 +1,44 @@
 
 #include "vector.h"
+#include "sparse_set.h"
+#include "sharded_vector.h"
+#include "rcu_vector.h"
+#include "seqlock_vector.h"
+#include "queues.h"
+#include "parallel.h"
+#include "sort.h"
+#include "packed_int_vector.h"
+#include "dict_vector.h"
+#include "string_vector.h"
+#include "column_table.h"
+#include "spill_vector.h"
+#include "external_sort.h"
+#include "vector_io.h"
+#include "async_io.h"
+#include "shm_vector.h"
+#include "vector_expr.h"
+#include "blas.h"
+#include "matrix_view.h"
+#include "concat.h"
+#include "vector_compare.h"
+#include "set_ops.h"
 
 #include <iostream>
 #include <stdexcept>
 #include <string>
 #include <vector>
+#include <list>
+#include <sstream>
 #include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <iterator>
+#include <unordered_set>
+#ifdef __cpp_lib_ranges
+#include <span>
+#endif
 
 namespace {
 
@@ -559,6 +592,1421 @@ void Test6() {
     }
 }
 
+void Test7() {
+    {
+        SparseSet<int> s;
+        s.Insert(5, 50);
+        s.Insert(100000, 7);
+        s.Insert(3, 30);
+        assert(s.Size() == 3);
+        assert(s.Contains(100000) && !s.Contains(4) && !s.Contains(1u << 30));
+        assert(s[5] == 50);
+        assert(s.Erase(5));
+        assert(!s.Erase(5));
+        assert(!s.Contains(5));
+        assert(s.Size() == 2);
+        assert(s[3] == 30 && s[100000] == 7);
+    }
+    {
+        SparseSet<int> a;
+        SparseSet<std::string> b;
+        for (uint32_t i = 0; i < 100; ++i) {
+            a.Insert(i, static_cast<int>(i));
+        }
+        b.Insert(10, "x");
+        b.Insert(500, "y");
+        int count = 0;
+        ForEachIntersection([&count](uint32_t key, int& x, std::string& y) {
+            assert(key == 10 && x == 10 && y == "x");
+            ++count;
+        }, a, b);
+        assert(count == 1);
+    }
+}
+
+void Test8() {
+    const size_t THREADS = 4;
+    const size_t PER_THREAD = 50'000;
+    ShardedVector<int> v(THREADS);
+    {
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < THREADS; ++t) {
+            workers.emplace_back([&v, t] {
+                for (size_t i = 0; i < PER_THREAD; ++i) {
+                    v.EmplaceBack(t, static_cast<int>(t * PER_THREAD + i));
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+    size_t visited = 0;
+    v.ForEach([&visited](int) {
+        ++visited;
+    });
+    assert(visited == THREADS * PER_THREAD);
+    Vector<int> all = v.Gather();
+    assert(all.Size() == THREADS * PER_THREAD);
+    assert(all.Capacity() == all.Size());
+    for (size_t i = 0; i < all.Size(); ++i) {
+        assert(all[i] == static_cast<int>(i));
+    }
+    assert(v.Size() == 0);
+    {
+        Obj::ResetCounters();
+        ShardedVector<Obj> objs(2);
+        objs.EmplaceBack(0, 1);
+        objs.EmplaceBack(1, 2);
+        Vector<Obj> gathered = objs.Gather();
+        assert(gathered.Size() == 2 && gathered[1].id == 2);
+        assert(Obj::GetAliveObjectCount() == 2);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+
+    // Размер, при котором size + max_count переполняется, отвергается до выделения
+    Vector<int> small(3);
+    bool thrown = false;
+    try {
+        small.AppendUninitialized(SIZE_MAX - 1, [](int*) -> size_t {
+            assert(false);
+            return 0;
+        });
+    } catch (const std::length_error&) {
+        thrown = true;
+    }
+    assert(thrown && small.Size() == 3 && small.Capacity() == 3);
+}
+
+void Test9() {
+    RcuVector<int> table;
+    table.Update([](Vector<int>& v) {
+        v.PushBack(1);
+    });
+    auto reader = table.RegisterReader();
+    {
+        auto snapshot = reader.Read();
+        assert(snapshot.Size() == 1);
+        table.Update([](Vector<int>& v) {
+            v.PushBack(2);
+        });
+        // Старая версия остаётся доступной, пока жив снимок
+        assert(snapshot.Size() == 1 && snapshot[0] == 1);
+        assert(table.PendingReclaim() == 1);
+    }
+    table.Reclaim();
+    assert(table.PendingReclaim() == 0);
+    assert(reader.Read().Size() == 2);
+
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; ++t) {
+        readers.emplace_back([&table, &stop] {
+            auto local = table.RegisterReader();
+            while (!stop.load()) {
+                auto snapshot = local.Read();
+                for (size_t i = 0; i < snapshot.Size(); ++i) {
+                    assert(snapshot[i] == static_cast<int>(i + 1));
+                }
+            }
+        });
+    }
+    for (int i = 3; i < 200; ++i) {
+        table.Update([i](Vector<int>& v) {
+            v.PushBack(i);
+        });
+    }
+    stop = true;
+    for (auto& t : readers) {
+        t.join();
+    }
+    assert(reader.Read().Size() == 199);
+}
+
+void Test10() {
+    struct Level {
+        int64_t price;
+        int64_t quantity;
+    };
+    const size_t LEVELS = 16;
+    SeqlockVector<Level> ladder(LEVELS);
+    assert(ladder.Load().Size() == 0);
+    std::atomic<bool> stop{false};
+    std::thread reader([&ladder, &stop] {
+        Vector<Level> snapshot;
+        while (!stop.load()) {
+            ladder.Load(snapshot);
+            for (size_t i = 0; i < snapshot.Size(); ++i) {
+                // Писатель всегда держит quantity == price * 2 для всех уровней
+                assert(snapshot[i].quantity == snapshot[i].price * 2);
+            }
+        }
+    });
+    for (int64_t round = 0; round < 10'000; ++round) {
+        ladder.Write([round](Level* levels, size_t& size) {
+            size = static_cast<size_t>(round) % LEVELS + 1;
+            for (size_t i = 0; i < size; ++i) {
+                levels[i] = Level{round + static_cast<int64_t>(i), (round + static_cast<int64_t>(i)) * 2};
+            }
+        });
+    }
+    stop = true;
+    reader.join();
+    ladder.Set(0, Level{1, 2});
+    assert(ladder.Load()[0].price == 1);
+    bool thrown = false;
+    try {
+        ladder.Store(Vector<Level>(LEVELS + 1));
+    } catch (const std::length_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+void Test11() {
+    const int COUNT = 100'000;
+    {
+        SpscQueue<int> q(1000);
+        assert(q.Capacity() == 1024);
+        std::thread producer([&q] {
+            int batch[7];
+            for (int i = 0; i < COUNT;) {
+                int n = std::min(7, COUNT - i);
+                for (int j = 0; j < n; ++j) {
+                    batch[j] = i + j;
+                }
+                int pushed = 0;
+                while (pushed < n) {
+                    pushed += static_cast<int>(q.TryPushBatch(batch + pushed, n - pushed));
+                }
+                i += n;
+            }
+        });
+        Vector<int> received;
+        while (received.Size() < static_cast<size_t>(COUNT)) {
+            int value = 0;
+            if (received.Size() % 2 == 0 && q.TryPop(value)) {
+                received.PushBack(value);
+            } else {
+                q.TryPopBatch(received, 64);
+            }
+        }
+        producer.join();
+        for (int i = 0; i < COUNT; ++i) {
+            assert(received[i] == i);
+        }
+    }
+    {
+        Obj::ResetCounters();
+        {
+            SpscQueue<Obj> q(4);
+            assert(q.TryEmplace(1));
+            assert(q.TryEmplace(2));
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        MpmcQueue<int64_t> q(256);
+        const int PRODUCERS = 3;
+        std::atomic<int64_t> sum{0};
+        std::atomic<int> consumed{0};
+        std::vector<std::thread> threads;
+        for (int p = 0; p < PRODUCERS; ++p) {
+            threads.emplace_back([&q] {
+                for (int64_t i = 1; i <= COUNT; ++i) {
+                    while (!q.TryPush(i)) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+        for (int c = 0; c < 2; ++c) {
+            threads.emplace_back([&] {
+                Vector<int64_t> batch;
+                while (consumed.load() < PRODUCERS * COUNT) {
+                    batch.Clear();
+                    const size_t n = q.TryPopBatch(batch, 32);
+                    for (int64_t v : batch) {
+                        sum += v;
+                    }
+                    consumed += static_cast<int>(n);
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        assert(sum.load() == int64_t{PRODUCERS} * COUNT * (COUNT + 1) / 2);
+        int64_t rest = 0;
+        assert(!q.TryPop(rest));
+    }
+}
+
+void Test12() {
+    const size_t SIZE = 100'000;
+    ThreadPool pool(3);
+    Vector<int64_t> v(SIZE);
+    for (const bool static_chunking : {false, true}) {
+        ParallelOptions options;
+        options.pool = &pool;
+        options.static_chunking = static_chunking;
+        options.grain_size = 1000;
+        ParallelForEach(v, [](int64_t& x) {
+            x = 1;
+        }, options);
+        assert(ParallelReduce(v, int64_t{0}, std::plus<>{}, options) == static_cast<int64_t>(SIZE));
+
+        Vector<int64_t> scanned;
+        ParallelScan(v, scanned, std::plus<>{}, options);
+        assert(scanned.Size() == SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(scanned[i] == static_cast<int64_t>(i + 1));
+        }
+
+        Vector<std::string> strings;
+        ParallelTransform(scanned, strings, [](int64_t x) {
+            return std::to_string(x);
+        }, options);
+        assert(strings.Size() == SIZE && strings[SIZE - 1] == std::to_string(SIZE));
+    }
+    {
+        Obj::ResetCounters();
+        Vector<int> ids(SIZE);
+        Vector<Obj> objs;
+        ParallelOptions options;
+        options.pool = &pool;
+        options.grain_size = 100;
+        std::atomic<size_t> calls{0};
+        try {
+            ParallelTransform(ids, objs, [&calls](int id) {
+                if (++calls == SIZE / 2) {
+                    throw std::runtime_error("Oops");
+                }
+                return Obj(id);
+            }, options);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(objs.Size() == 0);
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    assert(ParallelReduce(Vector<int>{}, 5, std::plus<>{}) == 5);
+}
+
+void Test13() {
+    std::mt19937_64 rng(42);
+    for (const size_t size : {0, 1, 5, 8, 100, 10'000}) {
+        Vector<uint64_t> u;
+        Vector<int32_t> s;
+        Vector<double> d;
+        std::vector<uint64_t> expected_u;
+        std::vector<int32_t> expected_s;
+        std::vector<double> expected_d;
+        for (size_t i = 0; i < size; ++i) {
+            const uint64_t x = rng();
+            u.PushBack(x);
+            s.PushBack(static_cast<int32_t>(x));
+            d.PushBack(static_cast<double>(static_cast<int64_t>(x)) / 1e6);
+            expected_u.push_back(x);
+            expected_s.push_back(static_cast<int32_t>(x));
+            expected_d.push_back(static_cast<double>(static_cast<int64_t>(x)) / 1e6);
+        }
+        std::sort(expected_u.begin(), expected_u.end());
+        std::sort(expected_s.begin(), expected_s.end());
+        std::sort(expected_d.begin(), expected_d.end());
+        Sort(u);
+        Sort(s);
+        RadixSort(d);
+        assert(std::equal(u.begin(), u.end(), expected_u.begin(), expected_u.end()));
+        assert(std::equal(s.begin(), s.end(), expected_s.begin(), expected_s.end()));
+        assert(std::equal(d.begin(), d.end(), expected_d.begin(), expected_d.end()));
+    }
+    {
+        struct Record {
+            uint32_t key;
+            uint32_t order;
+        };
+        Vector<Record> records;
+        for (uint32_t i = 0; i < 1000; ++i) {
+            records.PushBack(Record{i % 7, i});
+        }
+        RadixSortBy(records, [](const Record& r) {
+            return r.key;
+        });
+        for (size_t i = 1; i < records.Size(); ++i) {
+            assert(records[i - 1].key < records[i].key
+                   || (records[i - 1].key == records[i].key && records[i - 1].order < records[i].order));
+        }
+    }
+    {
+        ThreadPool pool(3);
+        ParallelOptions options;
+        options.pool = &pool;
+        options.grain_size = 1000;
+        Vector<std::string> words;
+        for (int i = 0; i < 10'007; ++i) {
+            words.PushBack(std::to_string(rng() % 100'000));
+        }
+        ParallelMergeSort(words, std::less<>{}, options);
+        assert(words.Size() == 10'007);
+        assert(std::is_sorted(words.begin(), words.end()));
+    }
+}
+
+// Блочная распаковка должна совпадать с поэлементным доступом при любых границах
+template <unsigned Bits>
+void CheckPackedDecode() {
+    std::mt19937_64 rng(Bits);
+    PackedIntVector<Bits> v;
+    for (size_t i = 0; i < 300; ++i) {
+        v.PushBack(i % 3 == 0 ? PackedIntVector<Bits>::MaxValue() : rng() & PackedIntVector<Bits>::MaxValue());
+    }
+    for (size_t first : {0, 1, 63, 64, 100}) {
+        const size_t count = v.Size() - first - first / 2;
+        std::vector<uint64_t> decoded(count);
+        v.DecodeRange(first, count, decoded.data());
+        for (size_t i = 0; i < count; ++i) {
+            assert(decoded[i] == v[first + i]);
+        }
+    }
+}
+
+void Test14() {
+    {
+        PackedIntVector<13> v;
+        for (uint64_t i = 0; i < 1000; ++i) {
+            v.PushBack(i * 7 % 8192);
+        }
+        assert(v.Size() == 1000);
+        for (uint64_t i = 0; i < 1000; ++i) {
+            assert(v[i] == i * 7 % 8192);
+        }
+        v.Set(5, 8191);
+        assert(v[4] == 28 && v[5] == 8191 && v[6] == 42);
+        assert(v.MemoryUsage() < 1000 * sizeof(uint32_t));
+        Vector<uint32_t> decoded;
+        v.Decode(decoded);
+        assert(decoded.Size() == 1000 && decoded[5] == 8191);
+        bool thrown = false;
+        try {
+            v.PushBack(8192);
+        } catch (const std::out_of_range&) {
+            thrown = true;
+        }
+        assert(thrown);
+        // Рост памяти геометрический: перевыделений логарифмически мало
+        ForIntVector many_f;
+        DeltaIntVector many_d;
+        size_t reallocations = 0;
+        for (uint64_t i = 0; i < 3'000'000; ++i) {
+            const size_t usage = many_f.MemoryUsage() + many_d.MemoryUsage();
+            many_f.PushBack(i * 7 % 1000);
+            many_d.PushBack(i * 3);
+            reallocations += many_f.MemoryUsage() + many_d.MemoryUsage() != usage;
+        }
+        assert(reallocations < 100);
+        assert(many_f[2'999'999] == 2'999'999 * 7 % 1000 && many_d[2'999'999] == 2'999'999 * 3);
+        CheckPackedDecode<1>();
+        CheckPackedDecode<7>();
+        CheckPackedDecode<31>();
+        CheckPackedDecode<33>();
+        CheckPackedDecode<63>();
+        CheckPackedDecode<64>();
+    }
+    {
+        ForIntVector f;
+        DeltaIntVector d;
+        std::vector<uint64_t> values;
+        for (uint64_t i = 0; i < 1000; ++i) {
+            values.push_back(1'000'000 + i * 5 + (i % 5));
+            f.PushBack(values.back());
+            d.PushBack(values.back());
+        }
+        assert(f.Size() == 1000 && d.Size() == 1000);
+        for (size_t i = 0; i < values.size(); ++i) {
+            assert(f[i] == values[i]);
+            assert(d[i] == values[i]);
+        }
+        Vector<uint64_t> decoded_f;
+        Vector<uint64_t> decoded_d;
+        f.Decode(decoded_f);
+        d.Decode(decoded_d);
+        assert(std::equal(decoded_f.begin(), decoded_f.end(), values.begin(), values.end()));
+        assert(std::equal(decoded_d.begin(), decoded_d.end(), values.begin(), values.end()));
+        assert(d.MemoryUsage() < values.size() * sizeof(uint32_t));
+        // Граничные ширины блоков: постоянный блок (0 бит) и полный диапазон (64 бита)
+        ForIntVector wide;
+        DeltaIntVector steps;
+        std::vector<uint64_t> wide_values;
+        std::vector<uint64_t> step_values;
+        for (uint64_t i = 0; i < 500; ++i) {
+            wide_values.push_back(i < 128 ? 42 : (i % 2 == 0 ? 0 : ~uint64_t{0} - i));
+            step_values.push_back(i < 128 ? 7 : (i < 256 ? 7 + i * i : (uint64_t{1} << 62) + i));
+            wide.PushBack(wide_values.back());
+            steps.PushBack(step_values.back());
+        }
+        Vector<uint64_t> decoded_wide;
+        Vector<uint64_t> decoded_steps;
+        wide.Decode(decoded_wide);
+        steps.Decode(decoded_steps);
+        assert(std::equal(decoded_wide.begin(), decoded_wide.end(), wide_values.begin(), wide_values.end()));
+        assert(std::equal(decoded_steps.begin(), decoded_steps.end(), step_values.begin(), step_values.end()));
+        for (size_t i = 0; i < step_values.size(); i += 37) {
+            assert(wide[i] == wide_values[i] && steps[i] == step_values[i]);
+        }
+        bool thrown = false;
+        try {
+            d.PushBack(0);
+        } catch (const std::invalid_argument&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+}
+
+void Test15() {
+    using namespace std::literals;
+    DictVector<std::string> countries;
+    for (int i = 0; i < 1000; ++i) {
+        countries.PushBack(i % 3 == 0 ? "RU"s : (i % 3 == 1 ? "DE"s : "US"s));
+    }
+    assert(countries.Size() == 1000);
+    assert(countries.Cardinality() == 3);
+    assert(countries.CodeWidth() == 1);
+    assert(countries[4] == "DE"s);
+    Vector<uint32_t> rows;
+    countries.FilterEqual("US"s, rows);
+    assert(rows.Size() == 333 && rows[0] == 2);
+    rows.Clear();
+    countries.FilterEqual("FR"s, rows);
+    assert(rows.Size() == 0);
+
+    DictVector<int> ids;
+    for (int i = 0; i < 70'000; ++i) {
+        ids.PushBack(i);
+        if (i == 300) {
+            assert(ids.CodeWidth() == 2);
+        }
+    }
+    assert(ids.CodeWidth() == 4);
+    assert(ids[299] == 299 && ids[69'999] == 69'999);
+    Vector<int> decoded;
+    ids.Decode(decoded);
+    assert(decoded.Size() == 70'000 && decoded[12'345] == 12'345);
+}
+
+void Test16() {
+    using namespace std::literals;
+    StringVector tokens = StringVector::Split("the quick  brown fox"sv, ' ');
+    assert(tokens.Size() == 5);
+    assert(tokens[0] == "the"sv && tokens[2].empty() && tokens[4] == "fox"sv);
+    assert(tokens.Chars() == "thequickbrownfox"sv);
+    tokens.EmplaceBack("jumps"sv);
+    assert(tokens.Size() == 6 && tokens[5] == "jumps"sv);
+    assert(std::count(tokens.begin(), tokens.end(), "fox"sv) == 1);
+    assert(tokens.end() - tokens.begin() == 6);
+
+    Vector<char> buffer;
+    tokens.Serialize(buffer);
+    StringVector restored = StringVector::Deserialize(std::string_view(buffer.begin(), buffer.Size()));
+    assert(std::equal(tokens.begin(), tokens.end(), restored.begin(), restored.end()));
+
+    bool thrown = false;
+    try {
+        StringVector::Deserialize(std::string_view(buffer.begin(), buffer.Size() - 1));
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    restored.PopBack();
+    assert(restored.Size() == 5 && restored.Bytes() == 16);
+    restored.Clear();
+    assert(restored.Empty() && restored.Bytes() == 0);
+
+    // Дописывание собственной строки, когда буфер символов при этом растёт
+    StringVector self;
+    self.PushBack("abcdefgh"sv);
+    for (int i = 0; i < 5; ++i) {
+        self.PushBack(self[self.Size() - 1]);
+        self.PushBack(self[0].substr(2, 3));
+    }
+    assert(self.Size() == 11 && self[1] == "abcdefgh"sv && self[2] == "cde"sv && self[10] == "cde"sv);
+    assert(self.Bytes() == 2 * 8 + 9 * 3);
+}
+
+void Test17() {
+    using namespace std::literals;
+    ColumnTable<int, std::string, double> table;
+    table.Reserve(100);
+    for (int i = 0; i < 100; ++i) {
+        table.AppendRow(i, std::to_string(i), i * 0.5);
+    }
+    assert(table.Size() == 100);
+    assert(table.Column<1>()[42] == "42"s);
+    // Изменяемый столбец — представление без PushBack/PopBack: длина остаётся общей
+    Span<double> halves = table.Column<2>();
+    assert(halves.Size() == table.Size());
+    halves[10] = 5.0;
+    assert(std::as_const(table).Column<2>()[10] == 5.0);
+    halves[10] = 10 * 0.5;
+
+    SelectionVector even;
+    table.Filter<0>([](int id) {
+        return id % 2 == 0;
+    }, nullptr, even);
+    SelectionVector selected;
+    table.Filter<2>([](double price) {
+        return price >= 40.0;
+    }, &even, selected);
+    assert(selected.Size() == 10 && selected[0] == 80);
+
+    double sum = 0;
+    size_t batches = 0;
+    table.Scan<2>(4, [&](const double* values, size_t count, const uint32_t* rows) {
+        assert(rows != nullptr && count <= 4);
+        for (size_t i = 0; i < count; ++i) {
+            assert(values[i] == rows[i] * 0.5);
+            sum += values[i];
+        }
+        ++batches;
+    }, &selected);
+    assert(batches == 3 && sum == 445.0);
+
+    auto projection = table.Project<0, 1>(&selected);
+    assert(projection.Size() == 10);
+    const auto [id, name] = projection[1];
+    assert(id == 82 && name == "82"s);
+    assert(&name == &table.Column<1>()[82]);
+    assert(projection.Column<1>()[9] == "98"s);
+}
+
+void Test18() {
+    const size_t COUNT = 100'000;
+    // Бюджет в четыре блока по 4 КиБ при 800 КиБ данных
+    SpillVector<uint64_t> v(16 * 1024, 4 * 1024);
+    for (uint64_t i = 0; i < COUNT; ++i) {
+        v.PushBack(i * 3);
+    }
+    assert(v.Size() == COUNT);
+    assert(v.Spilled());
+    assert(v.ResidentChunks() <= 4);
+    uint64_t expected = 0;
+    bool ordered = true;
+    v.ForEach([&](uint64_t value) {
+        ordered = ordered && value == expected;
+        expected += 3;
+    });
+    assert(ordered);
+    assert(v.Get(7) == 21);
+    v.Set(7, 1);
+    for (size_t i = 0; i < COUNT; i += 997) {
+        assert(v.Get(i) == (i == 7 ? 1 : i * 3));
+    }
+    assert(v.Get(7) == 1);
+    uint64_t window[1000];
+    v.CopyTo(50'000, 1000, window);
+    assert(window[0] == 150'000 && window[999] == 152'997);
+    assert(v.ResidentChunks() <= 4);
+}
+
+void Test19() {
+    std::mt19937_64 rng(7);
+    for (const size_t count : {0, 100, 50'000}) {
+        TempFile input;
+        TempFile output;
+        std::vector<uint64_t> expected;
+        for (size_t i = 0; i < count; ++i) {
+            expected.push_back(rng() % 1000);
+        }
+        io_detail::WriteAll(input.Fd(), expected.data(), expected.size() * sizeof(uint64_t));
+        lseek(input.Fd(), 0, SEEK_SET);
+        // Бюджет на 4096 записей даёт 13 участков, которые сливаются попарно в несколько проходов
+        assert(ExternalSort<uint64_t>(input.Fd(), output.Fd(), 4096 * sizeof(uint64_t)) == count);
+        std::sort(expected.begin(), expected.end());
+        std::vector<uint64_t> sorted(count);
+        io_detail::PReadAll(output.Fd(), sorted.data(), count * sizeof(uint64_t), 0);
+        assert(sorted == expected);
+    }
+    {
+        struct Record {
+            uint32_t key;
+            uint32_t payload;
+        };
+        TempFile input;
+        TempFile output;
+        for (uint32_t i = 0; i < 10'000; ++i) {
+            const Record record{static_cast<uint32_t>(rng() % 100), i};
+            io_detail::WriteAll(input.Fd(), &record, sizeof(record));
+        }
+        lseek(input.Fd(), 0, SEEK_SET);
+        const auto by_key_desc = [](const Record& lhs, const Record& rhs) {
+            return lhs.key > rhs.key;
+        };
+        assert(ExternalSort<Record>(input.Fd(), output.Fd(), 1000 * sizeof(Record), by_key_desc) == 10'000);
+        std::vector<Record> sorted(10'000);
+        io_detail::PReadAll(output.Fd(), sorted.data(), sorted.size() * sizeof(Record), 0);
+        assert(std::is_sorted(sorted.begin(), sorted.end(), by_key_desc));
+    }
+    {
+        // 9 участков при fan-in 4: сначала сливаются группами, блоки чтения по 64 КиБ
+        const size_t budget = 640 * 1024;
+        const size_t count = 9 * budget / sizeof(uint32_t) - 123;
+        TempFile input;
+        TempFile output;
+        std::vector<uint32_t> expected(count);
+        for (uint32_t& value : expected) {
+            value = static_cast<uint32_t>(rng());
+        }
+        io_detail::WriteAll(input.Fd(), expected.data(), count * sizeof(uint32_t));
+        lseek(input.Fd(), 0, SEEK_SET);
+        assert(ExternalSort<uint32_t>(input.Fd(), output.Fd(), budget) == count);
+        std::sort(expected.begin(), expected.end());
+        std::vector<uint32_t> sorted(count);
+        io_detail::PReadAll(output.Fd(), sorted.data(), count * sizeof(uint32_t), 0);
+        assert(sorted == expected);
+    }
+    {
+        TempFile input;
+        TempFile output;
+        io_detail::WriteAll(input.Fd(), "abc", 3);
+        lseek(input.Fd(), 0, SEEK_SET);
+        bool thrown = false;
+        try {
+            ExternalSort<uint32_t>(input.Fd(), output.Fd(), 1024);
+        } catch (const std::invalid_argument&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+}
+
+void Test20() {
+    const size_t COUNT = 10'000;
+    TempFile file;
+    Vector<uint32_t> source;
+    for (uint32_t i = 0; i < COUNT; ++i) {
+        source.PushBack(i * 7);
+    }
+    io_detail::WriteAll(file.Fd(), source.begin(), COUNT * sizeof(uint32_t));
+    {
+        lseek(file.Fd(), 0, SEEK_SET);
+        Vector<uint32_t> v;
+        assert(ReadAll(file.Fd(), v) == COUNT);
+        assert(v.Capacity() == COUNT);
+        assert(std::equal(v.begin(), v.end(), source.begin(), source.end()));
+    }
+    {
+        lseek(file.Fd(), 0, SEEK_SET);
+        Vector<uint32_t> v;
+        v.PushBack(42);
+        assert(ReadAppend(file.Fd(), v, 10 * sizeof(uint32_t) + 3) == 10);
+        assert(v.Size() == 11 && v[0] == 42 && v[10] == 63);
+        assert(ReadAll(file.Fd(), v) == COUNT - 10);
+        assert(v.Size() == COUNT + 1 && v[COUNT] == (COUNT - 1) * 7);
+        assert(ReadAppend(file.Fd(), v, 4096) == 0);
+    }
+    {
+        // Огромный предел на маленьком файле и в канале не резервирует предел целиком
+        TempFile small;
+        io_detail::WriteAll(small.Fd(), source.begin(), 10 * sizeof(uint32_t));
+        lseek(small.Fd(), 0, SEEK_SET);
+        Vector<uint32_t> v;
+        v.PushBack(42);
+        assert(ReadAppend(small.Fd(), v, size_t{1} << 30) == 10);
+        assert(v.Size() == 11 && v.Capacity() == 11 && v[10] == 63);
+        lseek(small.Fd(), 0, SEEK_SET);
+        assert(ReadAppend(small.Fd(), v, SIZE_MAX) == 10);
+        assert(v.Size() == 21 && v[20] == 63);
+
+        int fds[2];
+        assert(pipe(fds) == 0);
+        io_detail::WriteAll(fds[1], source.begin(), 100 * sizeof(uint32_t));
+        close(fds[1]);
+        Vector<uint32_t> piped;
+        assert(ReadAppend(fds[0], piped, SIZE_MAX) == 100);
+        close(fds[0]);
+        assert(piped[99] == 99 * 7 && piped.Capacity() * sizeof(uint32_t) <= io_detail::STREAM_STEP_BYTES);
+    }
+    {
+        int fds[2];
+        assert(pipe(fds) == 0);
+        std::thread writer([fd = fds[1], &source] {
+            for (size_t i = 0; i < COUNT; i += 1000) {
+                io_detail::WriteAll(fd, source.begin() + i, 1000 * sizeof(uint32_t));
+            }
+            close(fd);
+        });
+        Vector<uint32_t> v;
+        assert(ReadAll(fds[0], v) == COUNT);
+        writer.join();
+        close(fds[0]);
+        assert(std::equal(v.begin(), v.end(), source.begin(), source.end()));
+    }
+    {
+        TempFile odd;
+        io_detail::WriteAll(odd.Fd(), "abcde", 5);
+        lseek(odd.Fd(), 0, SEEK_SET);
+        Vector<uint32_t> v;
+        bool thrown = false;
+        try {
+            ReadAll(odd.Fd(), v);
+        } catch (const std::invalid_argument&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+}
+
+void Test21() {
+    using namespace std::literals;
+    TempFile file;
+    Vector<uint32_t> ids(3);
+    ids[2] = 7;
+    Vector<double> prices(2);
+    prices[1] = 1.5;
+    WriteTo(file.Fd(), ids, prices);
+
+    ShardedVector<uint32_t> shards(3);
+    shards.PushBack(0, 1u);
+    shards.PushBack(2, 2u);
+    shards.PushBack(2, 3u);
+    WriteTo(file.Fd(), shards);
+
+    StringVector strings = StringVector::Split("a,bc,def"sv, ',');
+    WriteTo(file.Fd(), strings);
+
+    lseek(file.Fd(), 0, SEEK_SET);
+    Vector<char> bytes;
+    ReadAll(file.Fd(), bytes);
+    const size_t header = 3 * sizeof(uint32_t) + 2 * sizeof(double);
+    assert(bytes.Size() > header + 3 * sizeof(uint32_t));
+    uint32_t last_id = 0;
+    double last_price = 0;
+    std::memcpy(&last_id, bytes.begin() + 2 * sizeof(uint32_t), sizeof(last_id));
+    std::memcpy(&last_price, bytes.begin() + 3 * sizeof(uint32_t) + sizeof(double), sizeof(last_price));
+    assert(last_id == 7 && last_price == 1.5);
+    uint32_t gathered[3];
+    std::memcpy(gathered, bytes.begin() + header, sizeof(gathered));
+    assert(gathered[0] == 1 && gathered[1] == 2 && gathered[2] == 3);
+    const size_t strings_start = header + sizeof(gathered);
+    StringVector restored = StringVector::Deserialize(
+            std::string_view(bytes.begin() + strings_start, bytes.Size() - strings_start));
+    assert(restored.Size() == 3 && restored[2] == "def"sv);
+
+    TempFile empty_file;
+    WriteTo(empty_file.Fd(), StringVector{});
+    lseek(empty_file.Fd(), 0, SEEK_SET);
+    Vector<char> empty_bytes;
+    ReadAll(empty_file.Fd(), empty_bytes);
+    assert(StringVector::Deserialize(std::string_view(empty_bytes.begin(), empty_bytes.Size())).Empty());
+}
+
+void Test22() {
+    const size_t count = 100000;
+    Vector<uint64_t> values(count);
+    for (size_t i = 0; i < count; ++i) {
+        values[i] = i * 2654435761u;
+    }
+    for (bool use_io_uring : {true, false}) {
+        AsyncIoOptions options;
+        options.chunk_bytes = 64 * 1024;
+        options.queue_depth = 4;
+        options.use_io_uring = use_io_uring;
+        TempFile file;
+        const off_t offset = 4096;
+        std::future<void> stored = AsyncStore(file.Fd(), values, offset, options);
+        stored.get();
+
+        std::future<Vector<uint64_t>> loaded = AsyncLoad<uint64_t>(file.Fd(), count, offset, options);
+        const Vector<uint64_t> result = loaded.get();
+        assert(result.Size() == count);
+        assert(std::equal(result.begin(), result.end(), values.begin()));
+
+        // Файл короче запрошенного: ошибка приходит через future
+        bool failed = false;
+        try {
+            AsyncLoad<uint64_t>(file.Fd(), count + 1, offset, options).get();
+        } catch (const std::system_error&) {
+            failed = true;
+        }
+        assert(failed);
+
+        // Тот же файл через O_DIRECT: смещение и конец диапазона не выровнены,
+        // а длина файла не кратна блоку. Файловые системы без O_DIRECT пропускаются
+        const std::string path = "/proc/self/fd/" + std::to_string(file.Fd());
+        const int direct_fd = ::open(path.c_str(), O_RDWR | O_DIRECT);
+        if (direct_fd < 0) {
+            continue;
+        }
+        options.alignment = DirectIoAlignment(direct_fd);
+        const Vector<uint64_t> direct = AsyncLoad<uint64_t>(direct_fd, count - 3, offset + 24, options).get();
+        assert(direct.Size() == count - 3);
+        assert(std::equal(direct.begin(), direct.end(), values.begin() + 3));
+
+        Vector<uint64_t> block(options.alignment / sizeof(uint64_t));
+        std::iota(block.begin(), block.end(), uint64_t{7});
+        AsyncStore(direct_fd, block, 0, options).get();
+        const Vector<uint64_t> block_back = AsyncLoad<uint64_t>(file.Fd(), block.Size()).get();
+        assert(std::equal(block.begin(), block.end(), block_back.begin(), block_back.end()));
+        bool unaligned = false;
+        try {
+            AsyncStore(direct_fd, block, 8, options);
+        } catch (const std::invalid_argument&) {
+            unaligned = true;
+        }
+        assert(unaligned);
+        ::close(direct_fd);
+    }
+}
+
+void Test23() {
+    const std::string name = "/advanced_vector_test_" + std::to_string(getpid());
+    ShmVector<int> writer = ShmVector<int>::Create(name, 1000);
+    ShmVector<int> reader = ShmVector<int>::Open(name);
+
+    // Заголовок сегмента не даёт открыть его с другим типом элементов
+    bool mismatch = false;
+    try {
+        ShmVector<double>::Open(name);
+    } catch (const std::system_error&) {
+        assert(false);
+    } catch (const std::runtime_error& e) {
+        mismatch = std::string(e.what()).find("type mismatch") != std::string::npos;
+    }
+    assert(mismatch);
+
+    ShmVector<int>::Unlink(name);
+    assert(reader.Capacity() == 1000 && reader.Size() == 0 && reader.Version() == 0);
+
+    Vector<int> values(500);
+    std::iota(values.begin(), values.end(), 0);
+    writer.Store(values);
+    assert(reader.Version() == 1 && reader.Size() == 500);
+    int sum = 0;
+    reader.Read([&sum](const int* data, size_t size) {
+        sum = std::accumulate(data, data + size, 0);
+    });
+    assert(sum == 499 * 500 / 2);
+
+    writer.Update([](int* data, size_t& size) {
+        data[size++] = -1;
+    });
+    Vector<int> snapshot = reader.Load();
+    assert(snapshot.Size() == 501 && snapshot[0] == 0 && snapshot[500] == -1);
+
+    // Читатель всегда видит согласованный снимок: все элементы равны. Начальный
+    // снимок тоже однородный, иначе читатель мог бы застать 501 элемент выше
+    writer.Store(Vector<int>(1));
+    std::atomic<bool> stop{false};
+    std::thread reader_thread([&reader, &stop] {
+        Vector<int> copy;
+        while (!stop.load()) {
+            reader.Load(copy);
+            for (int value : copy) {
+                assert(value == copy[0]);
+            }
+        }
+    });
+    for (int round = 0; round < 2000; ++round) {
+        Vector<int> same(1 + round % 1000);
+        std::fill(same.begin(), same.end(), round);
+        writer.Store(same);
+    }
+    stop = true;
+    reader_thread.join();
+
+    bool unlinked = false;
+    try {
+        ShmVector<int>::Open(name);
+    } catch (const std::system_error& e) {
+        unlinked = e.code() == std::errc::no_such_file_or_directory;
+    }
+    assert(unlinked);
+
+    bool too_large = false;
+    try {
+        ShmVector<int>::Create(name, std::numeric_limits<size_t>::max() / 2);
+    } catch (const std::length_error&) {
+        too_large = true;
+    }
+    assert(too_large);
+
+    // Писатель, упавший посреди записи, оставляет seq нечётным; повреждённая
+    // ёмкость в заголовке не должна переполнять проверку размера
+    ShmVector<int> crashed = ShmVector<int>::Create(name, 10);
+    crashed.Store(Vector<int>(3));
+    ShmVector<int> stuck = ShmVector<int>::Open(name);
+    const int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+    assert(fd >= 0);
+    void* mapped = ::mmap(nullptr, sizeof(shm_detail::Header), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    assert(mapped != MAP_FAILED);
+    auto* header = static_cast<shm_detail::Header*>(mapped);
+    header->slots[header->version.load() & 1].seq.fetch_add(1);
+    bool timed_out = false;
+    try {
+        stuck.Read([](const int*, size_t) {});
+    } catch (const std::runtime_error& e) {
+        timed_out = std::string(e.what()).find("did not finish") != std::string::npos;
+    }
+    assert(timed_out);
+    header->capacity = std::numeric_limits<uint64_t>::max() / 2;
+    bool truncated = false;
+    try {
+        ShmVector<int>::Open(name);
+    } catch (const std::runtime_error& e) {
+        truncated = std::string(e.what()).find("truncated") != std::string::npos;
+    }
+    assert(truncated);
+    ::munmap(mapped, sizeof(shm_detail::Header));
+    ::close(fd);
+    ShmVector<int>::Unlink(name);
+}
+
+void Test24() {
+    const size_t size = 1000;
+    Vector<double> a(size);
+    Vector<double> b(size);
+    Vector<int> c(size);
+    for (size_t i = 0; i < size; ++i) {
+        a[i] = static_cast<double>(i);
+        b[i] = 0.5;
+        c[i] = static_cast<int>(i % 7) - 3;
+    }
+
+    Vector<double> result = Evaluate(a + b * c);
+    assert(result.Size() == size);
+    for (size_t i = 0; i < size; ++i) {
+        assert(result[i] == a[i] + b[i] * c[i]);
+    }
+
+    Assign(result, Sqrt(a * a) - 1.0);
+    assert(result[10] == 9.0);
+
+    // На месте: операнд совпадает с приёмником
+    Assign(a, a * 2.0 + 1);
+    assert(a[0] == 1.0 && a[999] == 1999.0);
+
+    Vector<int> clipped;
+    Assign(clipped, Where(Lt(c, 0), -c, Min(c, 2)));
+    for (size_t i = 0; i < size; ++i) {
+        assert(clipped[i] == (c[i] < 0 ? -c[i] : std::min(c[i], 2)));
+    }
+    Vector<bool> positive = Evaluate(Gt(Abs(c), 2));
+    assert(positive[0] && !positive[1] && positive[6]);
+
+    // Скалярная арифметика не перехватывается
+    static_assert(std::is_same_v<decltype(1 + 2.0), double>);
+}
+
+template <typename T>
+void CheckBlas(const BlasOptions& options) {
+    const size_t size = 10007;
+    Vector<T> x(size);
+    Vector<T> y(size);
+    long double dot = 0;
+    long double asum = 0;
+    for (size_t i = 0; i < size; ++i) {
+        x[i] = static_cast<T>((i % 13) * 0.25) - T{1.5};
+        y[i] = static_cast<T>(i % 7) + T{0.5};
+        dot += static_cast<long double>(x[i]) * y[i];
+        asum += std::abs(static_cast<long double>(x[i]));
+    }
+    x[4321] = T{-100};
+    dot += (-100.0L - (static_cast<T>((4321 % 13) * 0.25) - T{1.5})) * y[4321];
+    asum += 100.0L - std::abs(static_cast<long double>(static_cast<T>((4321 % 13) * 0.25) - T{1.5}));
+
+    const long double tolerance = std::is_same_v<T, float> ? 1e-4L : 1e-12L;
+    assert(std::abs(Dot(x, y, options) - dot) <= tolerance * asum * 7);
+    assert(std::abs(Asum(x, options) - asum) <= tolerance * asum);
+    assert(std::abs(Nrm2(y, options) - std::sqrt(static_cast<long double>(Dot(y, y, options)))) <= tolerance * 100);
+    assert(Iamax(x, options) == 4321);
+
+    Vector<T> z = y;
+    Axpy(T{2}, x, z, options);
+    Scale(T{0.5}, z, options);
+    for (size_t i = 0; i < size; i += 101) {
+        assert(std::abs(z[i] - (y[i] + 2 * x[i]) / 2) <= 1e-3);
+    }
+
+    // Масштабирование спасает норму от переполнения и потери точности
+    const T huge = std::numeric_limits<T>::max() / 4;
+    Vector<T> big(3);
+    big[0] = huge;
+    big[1] = huge;
+    assert(std::abs(Nrm2(big, options) / (huge * std::sqrt(T{2})) - 1) < 1e-5);
+    const T tiny = std::numeric_limits<T>::denorm_min() * 1024;
+    Vector<T> small(2);
+    small[0] = tiny;
+    small[1] = tiny;
+    assert(std::abs(Nrm2(small, options) / (tiny * std::sqrt(T{2})) - 1) < 1e-2);
+}
+
+void Test25() {
+    for (SimdLevel simd : {SimdLevel::BASELINE, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        for (Summation summation : {Summation::FAST, Summation::KAHAN, Summation::PAIRWISE}) {
+            for (size_t threshold : {size_t{1} << 20, size_t{1000}}) {
+                BlasOptions options;
+                options.max_simd = simd;
+                options.summation = summation;
+                options.parallel_threshold = threshold;
+                options.grain_size = 1000;
+                CheckBlas<float>(options);
+                CheckBlas<double>(options);
+            }
+        }
+    }
+
+    // Компенсированное суммирование не теряет малые слагаемые на фоне большого
+    Vector<float> values(4097);
+    values[0] = 1e8f;
+    for (size_t i = 1; i < values.Size(); ++i) {
+        values[i] = 1.0f;
+    }
+    BlasOptions kahan;
+    kahan.summation = Summation::KAHAN;
+    assert(Asum(values, kahan) == 1e8f + 4096.0f);
+    assert(Iamax(Vector<double>{}) == 0);
+}
+
+void Test26() {
+    const size_t rows = 70;
+    const size_t cols = 45;
+    Vector<double> storage(rows * cols);
+    for (size_t i = 0; i < storage.Size(); ++i) {
+        storage[i] = static_cast<double>(i);
+    }
+    MatrixView<double> m(storage, rows, cols);
+    assert(m(3, 4) == 3 * cols + 4);
+
+    // Столбец читается на месте, без копирования во временный вектор
+    StridedView<double> column = m.Column(7);
+    assert(column.Size() == rows && column.Stride() == cols);
+    double sum = 0;
+    for (double value : column) {
+        sum += value;
+    }
+    assert(sum == static_cast<double>(rows * 7 + cols * rows * (rows - 1) / 2));
+    // Последний столбец: end() не выходит за буфер, обход идёт по номеру элемента
+    StridedView<const double> last_column = MatrixView<const double>(m).Column(cols - 1);
+    assert(static_cast<size_t>(std::distance(last_column.begin(), last_column.end())) == rows);
+    assert(*std::max_element(last_column.begin(), last_column.end()) == storage[storage.Size() - 1]);
+    column[2] = -1;
+    assert(storage[2 * cols + 7] == -1);
+    column[2] = 2 * cols + 7;
+
+    MatrixView<const double> sub = m.Submatrix(10, 5, 40, 33);
+    assert(sub.LeadingDimension() == cols && sub(1, 2) == m(11, 7));
+    assert(sub.Row(3)[4] == m(13, 9) && sub.Column(4)[3] == m(13, 9));
+
+    Vector<double> transposed(sub.Rows() * sub.Cols());
+    MatrixView<double> t(transposed, sub.Cols(), sub.Rows());
+    Transpose(sub, t);
+    for (size_t r = 0; r < sub.Rows(); ++r) {
+        for (size_t c = 0; c < sub.Cols(); ++c) {
+            assert(t(c, r) == sub(r, c));
+        }
+    }
+
+    Vector<double> square(37 * 37);
+    std::iota(square.begin(), square.end(), 0.0);
+    MatrixView<double> sq(square, 37, 37);
+    TransposeInPlace(sq);
+    assert(sq(0, 36) == 36 * 37 && sq(36, 0) == 36 && sq(20, 20) == 20 * 38);
+
+    Vector<double> copy(sub.Rows() * sub.Cols());
+    CopyMatrix(sub, MatrixView<double>(copy, sub.Rows(), sub.Cols()));
+    assert(copy[33 + 2] == sub(1, 2));
+
+    Vector<double> tiles;
+    CopyTiled(sub, 16, 16, tiles);
+    assert(tiles.Size() == sub.Rows() * sub.Cols());
+    // Вторая плитка первой полосы начинается с sub(0, 16)
+    assert(tiles[0] == sub(0, 0) && tiles[1 * 16] == sub(1, 0) && tiles[16 * 16] == sub(0, 16));
+
+    StridedView<int> evens;
+    Vector<int> numbers(9);
+    std::iota(numbers.begin(), numbers.end(), 0);
+    evens = StridedView<int>(numbers, 0, 2);
+    Vector<int> collected;
+    evens.CopyTo(collected);
+    assert(collected.Size() == 5 && collected[4] == 8);
+}
+
+int SumSpan(Span<const int> values) {
+    return std::accumulate(values.begin(), values.end(), 0);
+}
+
+void Test27() {
+    Vector<int> v(10);
+    std::iota(v.begin(), v.end(), 0);
+    assert(v.size() == 10 && !v.empty() && v.data() == v.begin());
+
+    // Подмассив передаётся в функцию без копирования
+    Span<int> middle = v.Slice(2, 5);
+    assert(middle.Size() == 5 && middle[0] == 2 && middle.data() == v.begin() + 2);
+    assert(SumSpan(middle) == 2 + 3 + 4 + 5 + 6);
+    assert(SumSpan(v.AsSpan()) == 45);
+    Span<int> tail = middle.Subspan(3);
+    assert(tail.Size() == 2 && tail[1] == 6);
+    assert(middle.First(1)[0] == 2 && middle.Last(1)[0] == 6 && middle.Subspan(5).Empty());
+    tail[0] = -1;
+    assert(v[5] == -1);
+
+    const std::list<std::string> words{"a", "bb", "ccc"};
+    Vector<std::string> from_list(words.begin(), words.end());
+    assert(from_list.Size() == 3 && from_list.Capacity() == 3 && from_list[2] == "ccc");
+    Vector<std::string> from_range = Vector<std::string>::FromRange(words);
+    assert(from_range.Capacity() == 3 && from_range[1] == "bb");
+
+    std::istringstream input("1 2 3 4");
+    struct InputRange {
+        std::istream& in;
+        std::istream_iterator<int> begin() const {
+            return std::istream_iterator<int>(in);
+        }
+        std::istream_iterator<int> end() const {
+            return {};
+        }
+    };
+    Vector<int> parsed = Vector<int>::FromRange(InputRange{input});
+    assert(parsed.Size() == 4 && parsed[3] == 4);
+
+#ifdef __cpp_lib_ranges
+    static_assert(std::ranges::contiguous_range<Vector<int>> && std::ranges::sized_range<Vector<int>>);
+    static_assert(std::ranges::contiguous_range<Span<int>> && std::ranges::view<Span<int>>);
+    static_assert(std::ranges::borrowed_range<Span<const int>>);
+    std::ranges::sort(v, std::greater<>{});
+    assert(v[0] == 9 && std::ranges::is_sorted(v.Slice(0, 10), std::greater<>{}));
+    std::span<const int> standard = v.AsSpan();
+    assert(standard.size() == 10 && standard[0] == 9);
+    Vector<int> squares = Vector<int>::FromRange(std::views::iota(0, 5) | std::views::transform([](int x) {
+        return x * x;
+    }));
+    assert(squares.Capacity() == 5 && squares[4] == 16);
+#endif
+}
+
+void Test28() {
+    Vector<std::string> words;
+    words.Reserve(8);
+    words.PushBack("alpha");
+    words.PushBack("beta");
+    const std::string* address = words.begin();
+
+    Vector<std::string>::Buffer buffer = words.Release();
+    assert(words.Size() == 0 && words.Capacity() == 0);
+    assert(buffer.data == address && buffer.size == 2 && buffer.capacity == 8);
+
+    // Буфер возвращается без копирования и освобождается вектором
+    Vector<std::string> adopted = Vector<std::string>::Adopt(buffer);
+    assert(adopted.begin() == address && adopted.Size() == 2 && adopted.Capacity() == 8);
+    adopted.PushBack("gamma");
+    assert(adopted.begin() == address && adopted[2] == "gamma");
+
+    // Буфер, заполненный снаружи, например кодеком
+    const size_t capacity = 16;
+    uint8_t* raw = RawMemory<uint8_t>::Allocate(capacity);
+    std::memset(raw, 7, 10);
+    Vector<uint8_t> bytes = Vector<uint8_t>::Adopt(raw, 10, capacity);
+    assert(bytes.Size() == 10 && bytes[9] == 7);
+
+    Vector<uint8_t>::Buffer released = bytes.Release();
+    RawMemory<uint8_t>::Deallocate(released.data);
+}
+
+void Test29() {
+    Vector<std::string> first;
+    first.Reserve(16);
+    first.PushBack("a");
+    first.PushBack("b");
+    const std::string* first_buffer = first.begin();
+    Vector<std::string> second(2);
+    second[0] = "c";
+    second[1] = "d";
+    const Vector<std::string> third(1);
+
+    // Запаса первого операнда хватает: его буфер переходит в результат
+    Vector<std::string> stolen = Concat(std::move(first), second, third);
+    assert(stolen.begin() == first_buffer && stolen.Size() == 5 && stolen.Capacity() == 16);
+    assert(stolen[2] == "c" && second[0] == "c" && stolen[4].empty());
+
+    // Иначе одно выделение точно под сумму, rvalue-операнды перемещаются
+    Vector<std::string> exact = Concat(second, std::move(stolen));
+    assert(exact.Size() == 7 && exact.Capacity() == 7 && exact[2] == "a");
+    assert(stolen.Size() == 5 && stolen[0].empty());
+
+    Vector<Vector<int>> partials;
+    for (int i = 0; i < 100; ++i) {
+        Vector<int> partial(static_cast<size_t>(i % 5));
+        std::fill(partial.begin(), partial.end(), i);
+        partials.PushBack(std::move(partial));
+    }
+    Vector<int> combined = Concat(partials);
+    assert(combined.Size() == 200 && combined.Capacity() == 200);
+    assert(combined[0] == 1 && combined[199] == 99 && partials[99].Size() == 4);
+    Vector<int> moved = Concat(std::move(partials));
+    assert(moved.Size() == 200 && moved[3] == 3);
+    assert(Concat(Vector<Vector<int>>{}).Size() == 0);
+
+    const std::vector<Vector<int>> list(3, Vector<int>(2));
+    assert(Concat(list).Size() == 6);
+}
+
+template <typename T>
+void CheckOrder(const std::vector<T>& a, const std::vector<T>& b) {
+    const Vector<T> va(a.begin(), a.end());
+    const Vector<T> vb(b.begin(), b.end());
+    assert((va == vb) == (a == b));
+    assert((va != vb) == (a != b));
+    assert((va < vb) == (a < b));
+    assert((va > vb) == (a > b));
+    assert((va <= vb) == (a <= b));
+    assert((va >= vb) == (a >= b));
+}
+
+template <typename T>
+Vector<T> Filled(size_t size, const T& value) {
+    Vector<T> result(size);
+    std::fill(result.begin(), result.end(), value);
+    return result;
+}
+
+void Test30() {
+    std::mt19937_64 rng(30);
+    // Расхождение в разных местах блоков SIMD и в хвосте
+    for (size_t size : {0, 1, 7, 16, 63, 64, 65, 200}) {
+        std::vector<int> a(size);
+        std::vector<double> x(size);
+        std::vector<uint8_t> bytes(size);
+        for (size_t i = 0; i < size; ++i) {
+            a[i] = static_cast<int>(rng() % 100) - 50;
+            x[i] = static_cast<double>(a[i]) / 4;
+            bytes[i] = static_cast<uint8_t>(rng());
+        }
+        CheckOrder(a, a);
+        CheckOrder(x, x);
+        CheckOrder(bytes, bytes);
+        for (size_t pos = 0; pos < size; pos += 5) {
+            std::vector<int> b = a;
+            b[pos] += pos % 2 == 0 ? 1 : -1;
+            CheckOrder(a, b);
+            CheckOrder(b, a);
+            std::vector<double> y = x;
+            y[pos] = -y[pos] - 1;
+            CheckOrder(x, y);
+            std::vector<uint8_t> other = bytes;
+            other[pos] ^= 0x80;
+            CheckOrder(bytes, other);
+            CheckOrder(other, bytes);
+        }
+        std::vector<int> prefix(a.begin(), a.begin() + size / 2);
+        CheckOrder(a, prefix);
+        CheckOrder(prefix, a);
+    }
+    CheckOrder<std::string>({"a", "b"}, {"a", "c"});
+    CheckOrder<std::string>({"a", "b"}, {"a"});
+    CheckOrder<int8_t>({-1, 5}, {1, 5});
+
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    assert(!(Filled<double>(1, nan) == Filled<double>(1, nan)));
+    assert((Filled<double>(3, -0.0) == Filled<double>(3, 0.0)));
+    assert(std::hash<Vector<double>>{}(Filled<double>(3, -0.0)) == std::hash<Vector<double>>{}(Filled<double>(3, 0.0)));
+    assert(!(Filled<double>(1, nan) < Filled<double>(1, 0.0)) && !(Filled<double>(1, 0.0) < Filled<double>(1, nan)));
+
+    // Дедупликация ключей-векторов байтов
+    std::unordered_set<Vector<uint8_t>> seen;
+    Vector<uint64_t> hashes;
+    for (size_t size = 0; size < 200; ++size) {
+        Vector<uint8_t> key(size);
+        std::iota(key.begin(), key.end(), uint8_t{0});
+        hashes.PushBack(HashVector(key));
+        assert(seen.insert(key).second);
+        assert(!seen.insert(std::move(key)).second);
+    }
+    std::sort(hashes.begin(), hashes.end());
+    assert(std::adjacent_find(hashes.begin(), hashes.end()) == hashes.end());
+    Vector<uint8_t> key = Filled<uint8_t>(100, 1);
+    const uint64_t before = HashVector(key);
+    key[57] = 2;
+    assert(HashVector(key) != before && HashVector(key, 1) != HashVector(key));
+
+    std::unordered_set<Vector<std::string>> words;
+    words.insert(Filled<std::string>(2, "x"));
+    assert(words.count(Filled<std::string>(2, "x")) == 1 && words.count(Filled<std::string>(1, "x")) == 0);
+}
+
+template <typename T>
+Vector<T> RandomSet(std::mt19937_64& rng, size_t size, uint64_t universe) {
+    std::vector<T> values(size);
+    for (T& value : values) {
+        value = static_cast<T>(rng() % universe);
+    }
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    return Vector<T>(values.begin(), values.end());
+}
+
+template <typename T>
+void CheckSetOps(const Vector<T>& a, const Vector<T>& b) {
+    std::vector<T> expected;
+    Vector<T> out(1);
+    out[0] = 42;
+    SetIntersection(a, b, out);
+    std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+    assert(out[0] == 42 && std::equal(out.begin() + 1, out.end(), expected.begin(), expected.end()));
+
+    out.Clear();
+    expected.clear();
+    SetDifference(a, b, out);
+    std::set_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+    assert(std::equal(out.begin(), out.end(), expected.begin(), expected.end()));
+
+    out.Clear();
+    expected.clear();
+    SetUnion(a, b, out);
+    std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+    assert(std::equal(out.begin(), out.end(), expected.begin(), expected.end()));
+}
+
+void Test31() {
+    std::mt19937_64 rng(31);
+    // Близкие размеры (блоки SIMD) и сильно различающиеся (галоп)
+    const std::pair<size_t, size_t> sizes[] = {{0, 0}, {0, 10}, {5, 3}, {100, 120}, {1000, 1000},
+                                               {3000, 20}, {10, 5000}, {1, 100000}};
+    for (const auto& [n, m] : sizes) {
+        for (uint64_t universe : {uint64_t{64}, uint64_t{4000}, uint64_t{1} << 40}) {
+            const auto a32 = RandomSet<uint32_t>(rng, n, std::min<uint64_t>(universe, UINT32_MAX));
+            const auto b32 = RandomSet<uint32_t>(rng, m, std::min<uint64_t>(universe, UINT32_MAX));
+            CheckSetOps(a32, b32);
+            CheckSetOps(b32, a32);
+            CheckSetOps(a32, a32);
+            CheckSetOps(RandomSet<int64_t>(rng, n, universe), RandomSet<int64_t>(rng, m, universe));
+            CheckSetOps(RandomSet<uint8_t>(rng, n % 256, 256), RandomSet<uint8_t>(rng, m % 256, 256));
+        }
+    }
+
+    for (size_t k : {0, 1, 2, 3, 7, 16}) {
+        std::list<Vector<uint32_t>> lists;
+        std::vector<uint32_t> expected;
+        for (size_t i = 0; i < k; ++i) {
+            const size_t size = i % 4 == 3 ? 0 : rng() % 300;
+            std::vector<uint32_t> list(size);
+            for (uint32_t& value : list) {
+                value = static_cast<uint32_t>(rng() % 500);
+            }
+            std::sort(list.begin(), list.end());
+            expected.insert(expected.end(), list.begin(), list.end());
+            lists.emplace_back(list.begin(), list.end());
+        }
+        std::sort(expected.begin(), expected.end());
+        Vector<uint32_t> merged;
+        MergeK(lists, merged);
+        assert(std::equal(merged.begin(), merged.end(), expected.begin(), expected.end()));
+        assert(merged.Capacity() == expected.size());
+    }
+}
+
 struct C {
     C() noexcept {
         ++def_ctor;
@@ -648,6 +2096,31 @@ int main() {
         Test4();
         Test5();
         Test6();
+        Test7();
+        Test8();
+        Test9();
+        Test10();
+        Test11();
+        Test12();
+        Test13();
+        Test14();
+        Test15();
+        Test16();
+        Test17();
+        Test18();
+        Test19();
+        Test20();
+        Test21();
+        Test22();
+        Test23();
+        Test24();
+        Test25();
+        Test26();
+        Test27();
+        Test28();
+        Test29();
+        Test30();
+        Test31();
         Benchmark();
     } catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
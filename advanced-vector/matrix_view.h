@@ -0,0 +1,304 @@
+#pragma once
+
+#include "vector.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+// Невладеющее представление элементов, идущих с постоянным шагом:
+// строка или столбец матрицы, каждый k-й элемент вектора
+template <typename T>
+class StridedView {
+public:
+    // Хранит начало представления и номер элемента: адрес вычисляется только
+    // при разыменовании, поэтому end() столбца не указывает за пределы буфера
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::remove_const_t<T>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+
+        iterator() = default;
+
+        T& operator*() const noexcept {
+            return data_[index_ * stride_];
+        }
+
+        iterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+
+        iterator operator++(int) noexcept {
+            iterator old = *this;
+            ++index_;
+            return old;
+        }
+
+        friend bool operator==(const iterator& lhs, const iterator& rhs) noexcept {
+            return lhs.data_ == rhs.data_ && lhs.index_ == rhs.index_;
+        }
+
+        friend bool operator!=(const iterator& lhs, const iterator& rhs) noexcept {
+            return !(lhs == rhs);
+        }
+
+    private:
+        friend class StridedView;
+
+        iterator(T* data, size_t index, size_t stride) noexcept
+                : data_(data)
+                , index_(index)
+                , stride_(stride) {
+        }
+
+        T* data_ = nullptr;
+        size_t index_ = 0;
+        size_t stride_ = 1;
+    };
+
+    StridedView() = default;
+
+    StridedView(T* data, size_t size, size_t stride = 1) noexcept
+            : data_(data)
+            , size_(size)
+            , stride_(stride) {
+        assert(stride != 0);
+    }
+
+    // Каждый stride-й элемент вектора, начиная с offset
+    template <typename U, typename = std::enable_if_t<std::is_same_v<std::remove_const_t<T>, U>>>
+    StridedView(Vector<U>& v, size_t offset, size_t stride) noexcept
+            : StridedView(v.begin() + offset, (v.Size() - offset + stride - 1) / stride, stride) {
+        assert(offset <= v.Size());
+    }
+
+    // Представление изменяемых элементов приводится к представлению константных
+    template <typename U, typename = std::enable_if_t<std::is_same_v<const U, T>>>
+    StridedView(const StridedView<U>& other) noexcept
+            : data_(other.Data())
+            , size_(other.Size())
+            , stride_(other.Stride()) {
+    }
+
+    T& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return data_[index * stride_];
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Stride() const noexcept {
+        return stride_;
+    }
+
+    T* Data() const noexcept {
+        return data_;
+    }
+
+    iterator begin() const noexcept {
+        return iterator(data_, 0, stride_);
+    }
+
+    iterator end() const noexcept {
+        return iterator(data_, size_, stride_);
+    }
+
+    // Дописывает элементы в out, сохраняя порядок
+    void CopyTo(Vector<std::remove_const_t<T>>& out) const {
+        out.AppendUninitialized(size_, [this](std::remove_const_t<T>* dst) {
+            std::uninitialized_copy(begin(), end(), dst);
+            return size_;
+        });
+    }
+
+private:
+    T* data_ = nullptr;
+    size_t size_ = 0;
+    size_t stride_ = 1;
+};
+
+// Невладеющее представление матрицы rows x cols, хранящейся по строкам.
+// Строки отстоят друг от друга на leading_dimension элементов, поэтому
+// подматрица — это то же представление с другим началом и размерами
+template <typename T>
+class MatrixView {
+public:
+    MatrixView() = default;
+
+    MatrixView(T* data, size_t rows, size_t cols, size_t leading_dimension) noexcept
+            : data_(data)
+            , rows_(rows)
+            , cols_(cols)
+            , ld_(leading_dimension) {
+        assert(leading_dimension >= cols);
+    }
+
+    MatrixView(T* data, size_t rows, size_t cols) noexcept
+            : MatrixView(data, rows, cols, cols) {
+    }
+
+    // Первые rows * cols элементов вектора как плотная матрица
+    template <typename U, typename = std::enable_if_t<std::is_same_v<std::remove_const_t<T>, U>>>
+    MatrixView(Vector<U>& v, size_t rows, size_t cols) noexcept
+            : MatrixView(v.begin(), rows, cols) {
+        assert(rows * cols <= v.Size());
+    }
+
+    template <typename U, typename = std::enable_if_t<std::is_same_v<std::remove_const_t<T>, U> && std::is_const_v<T>>>
+    MatrixView(const Vector<U>& v, size_t rows, size_t cols) noexcept
+            : MatrixView(v.begin(), rows, cols) {
+        assert(rows * cols <= v.Size());
+    }
+
+    template <typename U, typename = std::enable_if_t<std::is_same_v<const U, T>>>
+    MatrixView(const MatrixView<U>& other) noexcept
+            : MatrixView(other.Data(), other.Rows(), other.Cols(), other.LeadingDimension()) {
+    }
+
+    T& operator()(size_t row, size_t col) const noexcept {
+        assert(row < rows_ && col < cols_);
+        return data_[row * ld_ + col];
+    }
+
+    size_t Rows() const noexcept {
+        return rows_;
+    }
+
+    size_t Cols() const noexcept {
+        return cols_;
+    }
+
+    size_t LeadingDimension() const noexcept {
+        return ld_;
+    }
+
+    T* Data() const noexcept {
+        return data_;
+    }
+
+    // Строки лежат подряд без промежутков
+    bool IsContiguous() const noexcept {
+        return ld_ == cols_ || rows_ <= 1;
+    }
+
+    StridedView<T> Row(size_t row) const noexcept {
+        assert(row < rows_);
+        return StridedView<T>(data_ + row * ld_, cols_, 1);
+    }
+
+    StridedView<T> Column(size_t col) const noexcept {
+        assert(col < cols_);
+        return StridedView<T>(data_ + col, rows_, ld_);
+    }
+
+    MatrixView Submatrix(size_t row, size_t col, size_t rows, size_t cols) const noexcept {
+        assert(row + rows <= rows_ && col + cols <= cols_);
+        return MatrixView(data_ + row * ld_ + col, rows, cols, ld_);
+    }
+
+private:
+    T* data_ = nullptr;
+    size_t rows_ = 0;
+    size_t cols_ = 0;
+    size_t ld_ = 0;
+};
+
+namespace matrix_detail {
+
+// Блок 32 x 32 double (8 КиБ) помещается в L1 вместе с блоком приёмника
+inline constexpr size_t TILE = 32;
+
+}  // namespace matrix_detail
+
+// dst = srcᵀ. Обход блоками TILE x TILE: и чтение строк источника, и запись
+// строк приёмника остаются внутри кэша, а не проходят по столбцу через всю
+// матрицу. Представления не должны перекрываться
+template <typename S, typename T>
+void Transpose(MatrixView<S> src, MatrixView<T> dst) {
+    static_assert(std::is_same_v<std::remove_const_t<S>, T>, "Transpose requires matching element types");
+    assert(dst.Rows() == src.Cols() && dst.Cols() == src.Rows());
+    using matrix_detail::TILE;
+    for (size_t row_block = 0; row_block < src.Rows(); row_block += TILE) {
+        const size_t row_end = std::min(row_block + TILE, src.Rows());
+        for (size_t col_block = 0; col_block < src.Cols(); col_block += TILE) {
+            const size_t col_end = std::min(col_block + TILE, src.Cols());
+            for (size_t row = row_block; row < row_end; ++row) {
+                const T* src_row = src.Data() + row * src.LeadingDimension();
+                T* dst_col = dst.Data() + row;
+                for (size_t col = col_block; col < col_end; ++col) {
+                    dst_col[col * dst.LeadingDimension()] = src_row[col];
+                }
+            }
+        }
+    }
+}
+
+// Квадратная матрица транспонируется на месте обменом блоков относительно диагонали
+template <typename T>
+void TransposeInPlace(MatrixView<T> m) {
+    assert(m.Rows() == m.Cols());
+    using matrix_detail::TILE;
+    const size_t n = m.Rows();
+    for (size_t row_block = 0; row_block < n; row_block += TILE) {
+        const size_t row_end = std::min(row_block + TILE, n);
+        for (size_t col_block = row_block; col_block < n; col_block += TILE) {
+            const size_t col_end = std::min(col_block + TILE, n);
+            for (size_t row = row_block; row < row_end; ++row) {
+                for (size_t col = std::max(col_block, row + 1); col < col_end; ++col) {
+                    std::swap(m(row, col), m(col, row));
+                }
+            }
+        }
+    }
+}
+
+// Копирует src в dst того же размера. Плотные матрицы копируются одним
+// блоком, остальные — построчно, так что чтение и запись идут подряд
+template <typename S, typename T>
+void CopyMatrix(MatrixView<S> src, MatrixView<T> dst) {
+    static_assert(std::is_same_v<std::remove_const_t<S>, T>, "CopyMatrix requires matching element types");
+    assert(src.Rows() == dst.Rows() && src.Cols() == dst.Cols());
+    if (src.IsContiguous() && dst.IsContiguous()) {
+        std::copy_n(src.Data(), src.Rows() * src.Cols(), dst.Data());
+        return;
+    }
+    for (size_t row = 0; row < src.Rows(); ++row) {
+        std::copy_n(src.Data() + row * src.LeadingDimension(), src.Cols(), dst.Data() + row * dst.LeadingDimension());
+    }
+}
+
+// Дописывает в out матрицу, переложенную плитками tile_rows x tile_cols:
+// плитки идут по строкам, внутри плитки элементы тоже по строкам. Краевые
+// плитки неполные. Так блочные алгоритмы читают каждую плитку подряд
+template <typename T>
+void CopyTiled(MatrixView<T> src, size_t tile_rows, size_t tile_cols, Vector<std::remove_const_t<T>>& out) {
+    assert(tile_rows != 0 && tile_cols != 0);
+    const size_t count = src.Rows() * src.Cols();
+    out.AppendUninitialized(count, [&src, tile_rows, tile_cols](std::remove_const_t<T>* dst) {
+        size_t written = 0;
+        try {
+            for (size_t row_block = 0; row_block < src.Rows(); row_block += tile_rows) {
+                const size_t row_end = std::min(row_block + tile_rows, src.Rows());
+                for (size_t col_block = 0; col_block < src.Cols(); col_block += tile_cols) {
+                    const size_t width = std::min(col_block + tile_cols, src.Cols()) - col_block;
+                    for (size_t row = row_block; row < row_end; ++row) {
+                        std::uninitialized_copy_n(src.Data() + row * src.LeadingDimension() + col_block, width,
+                                                  dst + written);
+                        written += width;
+                    }
+                }
+            }
+        } catch (...) {
+            std::destroy_n(dst, written);
+            throw;
+        }
+        return written;
+    });
+}
@@ -0,0 +1,520 @@
+#pragma once
+
+#include "simd.h"
+#include "vector.h"
+
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+namespace bitpack_detail {
+
+inline constexpr size_t BLOCK_SIZE = 128;
+
+// Значений в блоке распаковки: 64 значения ширины w занимают ровно w слов,
+// поэтому блок, начинающийся на границе слова, не зависит от соседних
+inline constexpr size_t UNPACK_BLOCK = 64;
+
+inline uint64_t LowMask(unsigned width) noexcept {
+    return width >= 64 ? ~uint64_t{0} : (uint64_t{1} << width) - 1;
+}
+
+inline unsigned BitWidth(uint64_t value) noexcept {
+    unsigned width = 0;
+    while (value != 0) {
+        ++width;
+        value >>= 1;
+    }
+    return width;
+}
+
+// Читает width бит, начиная с бита bit_pos. Значение может пересекать границу слов
+inline uint64_t ReadBits(const uint64_t* words, size_t bit_pos, unsigned width) noexcept {
+    if (width == 0) {
+        return 0;
+    }
+    const size_t word = bit_pos >> 6;
+    const unsigned offset = bit_pos & 63;
+    uint64_t value = words[word] >> offset;
+    if (offset + width > 64) {
+        value |= words[word + 1] << (64 - offset);
+    }
+    return value & LowMask(width);
+}
+
+// Записывает width бит значения value в предварительно обнулённые биты
+inline void OrBits(uint64_t* words, size_t bit_pos, unsigned width, uint64_t value) noexcept {
+    if (width == 0) {
+        return;
+    }
+    const size_t word = bit_pos >> 6;
+    const unsigned offset = bit_pos & 63;
+    words[word] |= value << offset;
+    if (offset + width > 64) {
+        words[word + 1] |= value >> (64 - offset);
+    }
+}
+
+// Резервирует не меньше capacity элементов, увеличивая ёмкость хотя бы вдвое:
+// блоки дописываются по одному, и точный резерв копировал бы весь поток на каждом
+template <typename T>
+void ReserveAtLeast(Vector<T>& v, size_t capacity) {
+    if (capacity > v.Capacity()) {
+        v.Reserve(std::max(capacity, v.Capacity() * 2));
+    }
+}
+
+// Дописывает count значений шириной width в конец битового потока words,
+// занятого на bit_size бит. Возвращает новую длину потока в битах
+inline size_t AppendPacked(Vector<uint64_t>& words, size_t bit_size, const uint64_t* values,
+                           size_t count, unsigned width) {
+    const size_t new_bit_size = bit_size + count * width;
+    const size_t new_words = (new_bit_size + 63) / 64;
+    if (new_words > words.Size()) {
+        words.Resize(new_words);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        OrBits(words.begin(), bit_size + i * width, width, values[i]);
+    }
+    return new_bit_size;
+}
+
+// Распаковка блока из UNPACK_BLOCK значений ширины BITS. Значения
+// обрабатываются группами по числу 64-битных полос регистра: номера слов
+// и сдвиги известны при компиляции, а сдвиги по полосам выполняются одной
+// векторной инструкцией. Старшую часть значения берём из слова, где лежит
+// его последний бит, поэтому за пределы блока чтение не выходит
+template <unsigned BITS, typename V, size_t LANES, size_t GROUP, size_t... LANE>
+ADVANCED_VECTOR_INLINE void UnpackGroup(const uint64_t* in, uint64_t* out, std::index_sequence<LANE...>) noexcept {
+    constexpr size_t FIRST = GROUP * LANES;
+    constexpr V SHIFT = {((FIRST + LANE) * BITS % 64)...};
+    const V low = {in[(FIRST + LANE) * BITS / 64]...};
+    const V high = {in[((FIRST + LANE) * BITS + BITS - 1) / 64]...};
+    // Сдвиг на 1 и затем на 63 - SHIFT обнуляет старшую часть при SHIFT == 0
+    // без неопределённого сдвига на 64
+    V value = (low >> SHIFT) | ((high << 1) << (63 - SHIFT));
+    value &= LowMask(BITS);
+    simd_detail::Store(out + FIRST, value);
+}
+
+template <unsigned BITS, size_t BYTES, size_t... GROUP>
+ADVANCED_VECTOR_INLINE void UnpackGroups(const uint64_t* in, uint64_t* out, std::index_sequence<GROUP...>) noexcept {
+    using V = simd_detail::Simd<uint64_t, BYTES>;
+    constexpr size_t LANES = BYTES / sizeof(uint64_t);
+    (UnpackGroup<BITS, V, LANES, GROUP>(in, out, std::make_index_sequence<LANES>{}), ...);
+}
+
+template <unsigned BITS, size_t BYTES>
+ADVANCED_VECTOR_INLINE void UnpackKernel(const uint64_t* in, uint64_t* out) noexcept {
+    if constexpr (BITS == 0) {
+        std::fill_n(out, UNPACK_BLOCK, uint64_t{0});
+    } else {
+        UnpackGroups<BITS, BYTES>(in, out, std::make_index_sequence<UNPACK_BLOCK * sizeof(uint64_t) / BYTES>{});
+    }
+}
+
+// Точки входа для каждого набора инструкций, как в blas.h
+struct BaselineUnpack {
+    template <unsigned BITS>
+    static void Unpack(const uint64_t* in, uint64_t* out) noexcept {
+        UnpackKernel<BITS, 16>(in, out);
+    }
+};
+
+#if ADVANCED_VECTOR_X86_DISPATCH
+
+struct Avx2Unpack {
+    template <unsigned BITS>
+    ADVANCED_VECTOR_TARGET("avx2") static void Unpack(const uint64_t* in, uint64_t* out) noexcept {
+        UnpackKernel<BITS, 32>(in, out);
+    }
+};
+
+struct Avx512Unpack {
+    template <unsigned BITS>
+    ADVANCED_VECTOR_TARGET("avx512f") static void Unpack(const uint64_t* in, uint64_t* out) noexcept {
+        UnpackKernel<BITS, 64>(in, out);
+    }
+};
+
+#endif  // ADVANCED_VECTOR_X86_DISPATCH
+
+using UnpackFn = void (*)(const uint64_t*, uint64_t*) noexcept;
+
+// Ядра для всех ширин от 0 до 64, индекс — ширина
+struct UnpackTable {
+    UnpackFn by_width[65];
+};
+
+template <typename Kernels, size_t... WIDTH>
+constexpr UnpackTable MakeUnpackTable(std::index_sequence<WIDTH...>) noexcept {
+    return UnpackTable{{&Kernels::template Unpack<WIDTH>...}};
+}
+
+// Распаковывает UNPACK_BLOCK значений ширины width из блока, начинающегося
+// с слова in, ядром лучшего доступного набора инструкций
+inline void UnpackBlock(const uint64_t* in, unsigned width, uint64_t* out) noexcept {
+    using Widths = std::make_index_sequence<65>;
+    static constexpr UnpackTable BASELINE = MakeUnpackTable<BaselineUnpack>(Widths{});
+#if ADVANCED_VECTOR_X86_DISPATCH
+    static constexpr UnpackTable AVX2 = MakeUnpackTable<Avx2Unpack>(Widths{});
+    static constexpr UnpackTable AVX512 = MakeUnpackTable<Avx512Unpack>(Widths{});
+    const SimdLevel level = DetectSimdLevel();
+    if (level == SimdLevel::AVX512) {
+        AVX512.by_width[width](in, out);
+        return;
+    }
+    if (level == SimdLevel::AVX2) {
+        AVX2.by_width[width](in, out);
+        return;
+    }
+#endif
+    BASELINE.by_width[width](in, out);
+}
+
+// Распаковывает BLOCK_SIZE значений ширины width, записанных с бита
+// bit_offset. Блоки кодировщиков всегда начинаются на границе слова
+inline void UnpackFrame(const uint64_t* words, size_t bit_offset, unsigned width, uint64_t* out) noexcept {
+    assert(bit_offset % 64 == 0);
+    for (size_t i = 0; i < BLOCK_SIZE; i += UNPACK_BLOCK) {
+        UnpackBlock(words + bit_offset / 64 + i / UNPACK_BLOCK * width, width, out + i);
+    }
+}
+
+}  // namespace bitpack_detail
+
+// Вектор целых без знака фиксированной ширины Bits бит, упакованных вплотную
+// в слова RawMemory<uint64_t>. Доступ к элементу по индексу за O(1)
+template <unsigned Bits>
+class PackedIntVector {
+    static_assert(Bits >= 1 && Bits <= 64, "PackedIntVector supports widths from 1 to 64 bits");
+
+public:
+    PackedIntVector() = default;
+
+    explicit PackedIntVector(size_t size)
+            : words_(WordsFor(size))
+            , size_(size) {
+        std::uninitialized_value_construct_n(words_.GetAddress(), words_.Capacity());
+    }
+
+    PackedIntVector(const PackedIntVector& other)
+            : words_(other.words_.Capacity())
+            , size_(other.size_) {
+        std::uninitialized_copy_n(other.words_.GetAddress(), words_.Capacity(), words_.GetAddress());
+    }
+
+    PackedIntVector(PackedIntVector&& other) noexcept
+            : words_(std::move(other.words_))
+            , size_(std::exchange(other.size_, 0)) {
+    }
+
+    PackedIntVector& operator=(const PackedIntVector& rhs) {
+        if (this != &rhs) {
+            PackedIntVector temp(rhs);
+            Swap(temp);
+        }
+        return *this;
+    }
+
+    PackedIntVector& operator=(PackedIntVector&& rhs) noexcept {
+        if (this != &rhs) {
+            words_.Swap(rhs.words_);
+            size_ = std::exchange(rhs.size_, 0);
+        }
+        return *this;
+    }
+
+    void Swap(PackedIntVector& other) noexcept {
+        words_.Swap(other.words_);
+        std::swap(size_, other.size_);
+    }
+
+    static constexpr uint64_t MaxValue() noexcept {
+        return bitpack_detail::LowMask(Bits);
+    }
+
+    // Значение должно помещаться в Bits бит; бросает std::out_of_range в противном случае
+    void PushBack(uint64_t value) {
+        CheckValue(value);
+        if (WordsFor(size_ + 1) > words_.Capacity()) {
+            Grow(std::max<size_t>(WordsFor(size_ + 1), words_.Capacity() * 2));
+        }
+        bitpack_detail::OrBits(words_.GetAddress(), size_ * Bits, Bits, value);
+        ++size_;
+    }
+
+    uint64_t operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return bitpack_detail::ReadBits(words_.GetAddress(), index * Bits, Bits);
+    }
+
+    void Set(size_t index, uint64_t value) {
+        assert(index < size_);
+        CheckValue(value);
+        const size_t bit_pos = index * Bits;
+        uint64_t* words = words_.GetAddress();
+        const size_t word = bit_pos >> 6;
+        const unsigned offset = bit_pos & 63;
+        words[word] &= ~(MaxValue() << offset);
+        if (offset + Bits > 64) {
+            words[word + 1] &= ~(MaxValue() >> (64 - offset));
+        }
+        bitpack_detail::OrBits(words, bit_pos, Bits, value);
+    }
+
+    // Распаковывает count элементов начиная с first в out. Целые блоки по
+    // UNPACK_BLOCK значений распаковываются векторным ядром, края — поштучно
+    template <typename U>
+    void DecodeRange(size_t first, size_t count, U* out) const noexcept {
+        using bitpack_detail::UNPACK_BLOCK;
+        assert(first + count <= size_);
+        const uint64_t* words = words_.GetAddress();
+        const size_t last = first + count;
+        size_t i = first;
+        for (; i < last && i % UNPACK_BLOCK != 0; ++i) {
+            *out++ = static_cast<U>(bitpack_detail::ReadBits(words, i * Bits, Bits));
+        }
+        uint64_t block[UNPACK_BLOCK];
+        for (; i + UNPACK_BLOCK <= last; i += UNPACK_BLOCK) {
+            bitpack_detail::UnpackBlock(words + i / UNPACK_BLOCK * Bits, Bits, block);
+            for (uint64_t value : block) {
+                *out++ = static_cast<U>(value);
+            }
+        }
+        for (; i < last; ++i) {
+            *out++ = static_cast<U>(bitpack_detail::ReadBits(words, i * Bits, Bits));
+        }
+    }
+
+    // Дописывает все значения в конец out
+    template <typename U>
+    void Decode(Vector<U>& out) const {
+        out.AppendUninitialized(size_, [this](U* dst) {
+            DecodeRange(0, size_, dst);
+            return size_;
+        });
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return words_.Capacity() * 64 / Bits;
+    }
+
+    // Объём занятой памяти в байтах
+    size_t MemoryUsage() const noexcept {
+        return words_.Capacity() * sizeof(uint64_t);
+    }
+
+private:
+    static size_t WordsFor(size_t count) noexcept {
+        // Лишнее слово в конце позволяет читать пересекающие границу значения без проверок
+        return (count * Bits + 63) / 64 + (count != 0 ? 1 : 0);
+    }
+
+    static void CheckValue(uint64_t value) {
+        if (value > MaxValue()) {
+            throw std::out_of_range("PackedIntVector: value does not fit into the bit width");
+        }
+    }
+
+    void Grow(size_t new_words) {
+        RawMemory<uint64_t> new_data(new_words);
+        std::uninitialized_copy_n(words_.GetAddress(), words_.Capacity(), new_data.GetAddress());
+        std::uninitialized_value_construct_n(new_data.GetAddress() + words_.Capacity(),
+                                             new_words - words_.Capacity());
+        words_.Swap(new_data);
+    }
+
+    RawMemory<uint64_t> words_;
+    size_t size_ = 0;
+};
+
+// Вектор с кодированием «кадр отсчёта»: значения хранятся блоками по 128,
+// в каждом блоке — минимум и разности с ним минимально возможной ширины.
+// Доступ по индексу за O(1), подходит для неупорядоченных столбцов идентификаторов
+class ForIntVector {
+public:
+    void PushBack(uint64_t value) {
+        if (pending_.Size() == bitpack_detail::BLOCK_SIZE) {
+            Flush();
+        }
+        pending_.PushBack(value);
+    }
+
+    uint64_t operator[](size_t index) const noexcept {
+        assert(index < Size());
+        const size_t block_index = index / bitpack_detail::BLOCK_SIZE;
+        const size_t offset = index % bitpack_detail::BLOCK_SIZE;
+        if (block_index == blocks_.Size()) {
+            return pending_[offset];
+        }
+        const Block& block = blocks_[block_index];
+        return block.reference + bitpack_detail::ReadBits(words_.begin(), block.bit_offset + offset * block.width,
+                                                          block.width);
+    }
+
+    // Дописывает все значения в конец out, распаковывая блок за блоком
+    template <typename U>
+    void Decode(Vector<U>& out) const {
+        out.AppendUninitialized(Size(), [this](U* dst) {
+            uint64_t unpacked[bitpack_detail::BLOCK_SIZE];
+            for (const Block& block : blocks_) {
+                bitpack_detail::UnpackFrame(words_.begin(), block.bit_offset, block.width, unpacked);
+                for (uint64_t value : unpacked) {
+                    *dst++ = static_cast<U>(block.reference + value);
+                }
+            }
+            for (uint64_t value : pending_) {
+                *dst++ = static_cast<U>(value);
+            }
+            return Size();
+        });
+    }
+
+    size_t Size() const noexcept {
+        return blocks_.Size() * bitpack_detail::BLOCK_SIZE + pending_.Size();
+    }
+
+    size_t MemoryUsage() const noexcept {
+        return words_.Capacity() * sizeof(uint64_t) + blocks_.Capacity() * sizeof(Block)
+               + pending_.Capacity() * sizeof(uint64_t);
+    }
+
+private:
+    struct Block {
+        uint64_t reference;
+        size_t bit_offset;
+        unsigned width;
+    };
+
+    void Flush() {
+        const auto [min, max] = std::minmax_element(pending_.begin(), pending_.end());
+        const uint64_t reference = *min;
+        const unsigned width = bitpack_detail::BitWidth(*max - reference);
+        ReserveBlock(width);
+        for (uint64_t& value : pending_) {
+            value -= reference;
+        }
+        bit_size_ = bitpack_detail::AppendPacked(words_, bit_size_, pending_.begin(), pending_.Size(), width);
+        // Запас в одно слово для чтения значений на границе слов
+        words_.Resize(bit_size_ / 64 + 1);
+        blocks_.PushBack(Block{reference, bit_size_ - pending_.Size() * width, width});
+        pending_.Clear();
+    }
+
+    // Резервирует память под очередной блок, чтобы его запись не бросала исключений
+    void ReserveBlock(unsigned width) {
+        bitpack_detail::ReserveAtLeast(words_, (bit_size_ + bitpack_detail::BLOCK_SIZE * width) / 64 + 1);
+        bitpack_detail::ReserveAtLeast(blocks_, blocks_.Size() + 1);
+    }
+
+    Vector<uint64_t> words_;
+    size_t bit_size_ = 0;
+    Vector<Block> blocks_;
+    Vector<uint64_t> pending_;
+};
+
+// Дельта-кодирование неубывающих последовательностей (списков вхождений):
+// блоки по 128 значений хранят первое значение и разности соседних элементов.
+// Доступ по индексу требует суммирования разностей внутри блока, поэтому
+// основной сценарий — последовательная распаковка
+class DeltaIntVector {
+public:
+    // Бросает std::invalid_argument, если значение меньше предыдущего
+    void PushBack(uint64_t value) {
+        if (Size() != 0 && value < last_) {
+            throw std::invalid_argument("DeltaIntVector: values must be non-decreasing");
+        }
+        if (pending_.Size() == bitpack_detail::BLOCK_SIZE) {
+            Flush();
+        }
+        pending_.PushBack(value);
+        last_ = value;
+    }
+
+    uint64_t operator[](size_t index) const noexcept {
+        assert(index < Size());
+        const size_t block_index = index / bitpack_detail::BLOCK_SIZE;
+        const size_t offset = index % bitpack_detail::BLOCK_SIZE;
+        if (block_index == blocks_.Size()) {
+            return pending_[offset];
+        }
+        const Block& block = blocks_[block_index];
+        uint64_t value = block.base;
+        for (size_t i = 1; i <= offset; ++i) {
+            value += bitpack_detail::ReadBits(words_.begin(), block.bit_offset + i * block.width, block.width);
+        }
+        return value;
+    }
+
+    template <typename U>
+    void Decode(Vector<U>& out) const {
+        out.AppendUninitialized(Size(), [this](U* dst) {
+            uint64_t deltas[bitpack_detail::BLOCK_SIZE];
+            for (const Block& block : blocks_) {
+                bitpack_detail::UnpackFrame(words_.begin(), block.bit_offset, block.width, deltas);
+                uint64_t value = block.base;
+                for (uint64_t delta : deltas) {
+                    value += delta;
+                    *dst++ = static_cast<U>(value);
+                }
+            }
+            for (uint64_t value : pending_) {
+                *dst++ = static_cast<U>(value);
+            }
+            return Size();
+        });
+    }
+
+    size_t Size() const noexcept {
+        return blocks_.Size() * bitpack_detail::BLOCK_SIZE + pending_.Size();
+    }
+
+    size_t MemoryUsage() const noexcept {
+        return words_.Capacity() * sizeof(uint64_t) + blocks_.Capacity() * sizeof(Block)
+               + pending_.Capacity() * sizeof(uint64_t);
+    }
+
+private:
+    struct Block {
+        uint64_t base;
+        size_t bit_offset;
+        unsigned width;
+    };
+
+    void Flush() {
+        const uint64_t base = pending_[0];
+        uint64_t max_delta = 0;
+        for (size_t i = 1; i < pending_.Size(); ++i) {
+            max_delta = std::max(max_delta, pending_[i] - pending_[i - 1]);
+        }
+        const unsigned width = bitpack_detail::BitWidth(max_delta);
+        ReserveBlock(width);
+        for (size_t i = pending_.Size() - 1; i > 0; --i) {
+            pending_[i] -= pending_[i - 1];
+        }
+        // Первая разность всегда нулевая, но хранится: так блок из BLOCK_SIZE
+        // значений занимает целое число слов и распаковывается векторным ядром
+        pending_[0] = 0;
+        bit_size_ = bitpack_detail::AppendPacked(words_, bit_size_, pending_.begin(), pending_.Size(), width);
+        words_.Resize(bit_size_ / 64 + 1);
+        blocks_.PushBack(Block{base, bit_size_ - pending_.Size() * width, width});
+        pending_.Clear();
+    }
+
+    // Резервирует память под очередной блок, чтобы его запись не бросала исключений
+    void ReserveBlock(unsigned width) {
+        bitpack_detail::ReserveAtLeast(words_, (bit_size_ + bitpack_detail::BLOCK_SIZE * width) / 64 + 1);
+        bitpack_detail::ReserveAtLeast(blocks_, blocks_.Size() + 1);
+    }
+
+    Vector<uint64_t> words_;
+    size_t bit_size_ = 0;
+    Vector<Block> blocks_;
+    Vector<uint64_t> pending_;
+    uint64_t last_ = 0;
+};
@@ -0,0 +1,357 @@
+#pragma once
+
+#include "vector.h"
+#include "sharded_vector.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+// Пул потоков с перехватом работы: у каждого потока своя очередь задач,
+// свои задачи он берёт с конца, а простаивая, забирает чужие с начала
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit ThreadPool(size_t thread_count = DefaultThreadCount())
+            : queues_(thread_count == 0 ? 1 : thread_count)
+    {
+        workers_.Reserve(queues_.Size());
+        try {
+            for (size_t i = 0; i < queues_.Size(); ++i) {
+                workers_.EmplaceBack([this, i] {
+                    WorkerLoop(i);
+                });
+            }
+        } catch (...) {
+            Stop();
+            throw;
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        Stop();
+    }
+
+    size_t ThreadCount() const noexcept {
+        return queues_.Size();
+    }
+
+    // Ставит задачу в очередь потока worker % ThreadCount()
+    void Submit(Task task, size_t worker) {
+        WorkerQueue& queue = queues_[worker % queues_.Size()];
+        {
+            std::lock_guard guard(queue.mutex);
+            // Счётчик увеличивается до публикации: иначе забравший задачу поток
+            // мог бы уменьшить его первым и на миг перевести через ноль
+            queued_.fetch_add(1, std::memory_order_release);
+            try {
+                queue.tasks.push_back(std::move(task));
+            } catch (...) {
+                queued_.fetch_sub(1, std::memory_order_relaxed);
+                throw;
+            }
+        }
+        {
+            std::lock_guard guard(sleep_mutex_);
+        }
+        wake_.notify_one();
+    }
+
+    void Submit(Task task) {
+        Submit(std::move(task), next_worker_.fetch_add(1, std::memory_order_relaxed));
+    }
+
+    // Выполняет одну ожидающую задачу в текущем потоке, если она есть.
+    // Позволяет ожидающему потоку помогать пулу вместо простоя
+    bool TryRunPending() {
+        Task task;
+        if (!TrySteal(next_worker_.load(std::memory_order_relaxed), task)) {
+            return false;
+        }
+        task();
+        return true;
+    }
+
+    static size_t DefaultThreadCount() noexcept {
+        const size_t hardware = std::thread::hardware_concurrency();
+        return hardware == 0 ? 1 : hardware;
+    }
+
+private:
+    struct alignas(CACHE_LINE_SIZE) WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    bool TryPopOwn(size_t index, Task& task) {
+        WorkerQueue& queue = queues_[index];
+        std::lock_guard guard(queue.mutex);
+        if (queue.tasks.empty()) {
+            return false;
+        }
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        queued_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool TrySteal(size_t start, Task& task) {
+        for (size_t i = 0; i < queues_.Size(); ++i) {
+            WorkerQueue& queue = queues_[(start + i) % queues_.Size()];
+            std::lock_guard guard(queue.mutex);
+            if (!queue.tasks.empty()) {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                queued_.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void WorkerLoop(size_t index) {
+        Task task;
+        for (;;) {
+            if (TryPopOwn(index, task) || TrySteal(index + 1, task)) {
+                task();
+                task = nullptr;
+                continue;
+            }
+            std::unique_lock lock(sleep_mutex_);
+            wake_.wait(lock, [this] {
+                return stop_ || queued_.load(std::memory_order_acquire) != 0;
+            });
+            if (stop_ && queued_.load(std::memory_order_acquire) == 0) {
+                return;
+            }
+        }
+    }
+
+    void Stop() noexcept {
+        {
+            std::lock_guard guard(sleep_mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread& worker : workers_) {
+            worker.join();
+        }
+        workers_.Clear();
+    }
+
+    Vector<WorkerQueue> queues_;
+    Vector<std::thread> workers_;
+    std::atomic<size_t> queued_{0};
+    std::atomic<size_t> next_worker_{0};
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+};
+
+// Пул по умолчанию, создаётся при первом обращении
+inline ThreadPool& DefaultThreadPool() {
+    static ThreadPool pool;
+    return pool;
+}
+
+struct ParallelOptions {
+    // Число элементов в одной задаче; 0 — подобрать по размеру диапазона
+    size_t grain_size = 0;
+    // Статическое разбиение: ровно один непрерывный блок на поток пула.
+    // Блок 0 выполняет вызывающий поток, блок i ставится в очередь потока i,
+    // но простаивающий поток может его перехватить. Поэтому повторные проходы
+    // обычно, но не гарантированно, попадают в те же потоки
+    bool static_chunking = false;
+    ThreadPool* pool = nullptr;
+};
+
+namespace parallel_detail {
+
+inline constexpr size_t MIN_AUTO_GRAIN = 1024;
+
+// Вызывает body(chunk, begin, end) для блоков диапазона [0, count) в пуле
+// и дожидается завершения. Первое исключение из задач пробрасывается дальше
+template <typename Body>
+void ForChunks(size_t count, const ParallelOptions& options, Body&& body) {
+    if (count == 0) {
+        return;
+    }
+    ThreadPool& pool = options.pool != nullptr ? *options.pool : DefaultThreadPool();
+    size_t grain = options.grain_size;
+    if (options.static_chunking) {
+        grain = (count + pool.ThreadCount() - 1) / pool.ThreadCount();
+    } else if (grain == 0) {
+        grain = std::max(MIN_AUTO_GRAIN, (count + 4 * pool.ThreadCount() - 1) / (4 * pool.ThreadCount()));
+    }
+    const size_t chunks = (count + grain - 1) / grain;
+    if (chunks == 1) {
+        body(size_t{0}, size_t{0}, count);
+        return;
+    }
+
+    std::atomic<size_t> pending{chunks};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    auto run = [&](size_t chunk) noexcept {
+        const size_t begin = chunk * grain;
+        try {
+            body(chunk, begin, std::min(begin + grain, count));
+        } catch (...) {
+            std::lock_guard guard(error_mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+        pending.fetch_sub(1, std::memory_order_acq_rel);
+    };
+    // Нулевой блок выполняет вызывающий поток, остальные уходят в пул
+    for (size_t chunk = 1; chunk < chunks; ++chunk) {
+        try {
+            pool.Submit([&run, chunk] {
+                run(chunk);
+            }, chunk);
+        } catch (...) {
+            run(chunk);
+        }
+    }
+    run(0);
+    while (pending.load(std::memory_order_acquire) != 0) {
+        if (!pool.TryRunPending()) {
+            std::this_thread::yield();
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+// Дописывает в dst count элементов, которые construct(chunk, begin, end, T* out)
+// конструирует блоками в неинициализированной памяти. Если хотя бы один блок
+// завершился исключением, уже построенные блоки разрушаются
+template <typename T, typename Construct>
+void ConstructChunks(Vector<T>& dst, size_t count, const ParallelOptions& options, Construct&& construct) {
+    dst.AppendUninitialized(count, [&](T* out) {
+        Vector<std::pair<size_t, size_t>> done;
+        std::mutex done_mutex;
+        try {
+            ForChunks(count, options, [&](size_t chunk, size_t begin, size_t end) {
+                construct(chunk, begin, end, out + begin);
+                std::lock_guard guard(done_mutex);
+                try {
+                    done.PushBack(std::pair{begin, end});
+                } catch (...) {
+                    std::destroy(out + begin, out + end);
+                    throw;
+                }
+            });
+        } catch (...) {
+            for (const auto& [begin, end] : done) {
+                std::destroy(out + begin, out + end);
+            }
+            throw;
+        }
+        return count;
+    });
+}
+
+}  // namespace parallel_detail
+
+// Вызывает f(element) для каждого элемента вектора параллельно
+template <typename T, typename F>
+void ParallelForEach(Vector<T>& v, F&& f, const ParallelOptions& options = {}) {
+    T* data = v.begin();
+    parallel_detail::ForChunks(v.Size(), options, [data, &f](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            f(data[i]);
+        }
+    });
+}
+
+// Дописывает в dst результаты f(src[i]), конструируя их прямо
+// в неинициализированной памяти dst без промежуточной инициализации
+template <typename T, typename U, typename F>
+void ParallelTransform(const Vector<T>& src, Vector<U>& dst, F&& f, const ParallelOptions& options = {}) {
+    const T* data = src.begin();
+    parallel_detail::ConstructChunks(dst, src.Size(), options, [data, &f](size_t, size_t begin, size_t end, U* out) {
+        size_t i = begin;
+        try {
+            for (; i < end; ++i) {
+                new (out + (i - begin)) U(f(data[i]));
+            }
+        } catch (...) {
+            std::destroy_n(out, i - begin);
+            throw;
+        }
+    });
+}
+
+// Свёртка ассоциативной операцией op. Частичные результаты блоков
+// объединяются по порядку, поэтому коммутативность op не требуется
+template <typename T, typename R, typename Op>
+R ParallelReduce(const Vector<T>& v, R init, Op&& op, const ParallelOptions& options = {}) {
+    const T* data = v.begin();
+    Vector<std::unique_ptr<R>> partials;
+    std::mutex partials_mutex;
+    parallel_detail::ForChunks(v.Size(), options, [&](size_t chunk, size_t begin, size_t end) {
+        auto partial = std::make_unique<R>(data[begin]);
+        for (size_t i = begin + 1; i < end; ++i) {
+            *partial = op(std::move(*partial), data[i]);
+        }
+        std::lock_guard guard(partials_mutex);
+        if (partials.Size() <= chunk) {
+            partials.Resize(chunk + 1);
+        }
+        partials[chunk] = std::move(partial);
+    });
+    for (auto& partial : partials) {
+        init = op(std::move(init), std::move(*partial));
+    }
+    return init;
+}
+
+// Включающий префиксный проход: dst[i] = src[0] op ... op src[i].
+// Два прохода: суммы блоков, затем пересчёт блоков со смещением
+template <typename T, typename Op = std::plus<>>
+void ParallelScan(const Vector<T>& src, Vector<T>& dst, Op op = {}, const ParallelOptions& options = {}) {
+    const T* data = src.begin();
+    Vector<std::unique_ptr<T>> sums;
+    std::mutex sums_mutex;
+    parallel_detail::ForChunks(src.Size(), options, [&](size_t chunk, size_t begin, size_t end) {
+        auto sum = std::make_unique<T>(data[begin]);
+        for (size_t i = begin + 1; i < end; ++i) {
+            *sum = op(*sum, data[i]);
+        }
+        std::lock_guard guard(sums_mutex);
+        if (sums.Size() <= chunk) {
+            sums.Resize(chunk + 1);
+        }
+        sums[chunk] = std::move(sum);
+    });
+    // sums[i] превращается в сумму всех блоков до i-го включительно
+    for (size_t i = 1; i < sums.Size(); ++i) {
+        *sums[i] = op(*sums[i - 1], *sums[i]);
+    }
+    // Разбиение на блоки зависит только от размера и настроек, поэтому совпадает с первым проходом
+    parallel_detail::ConstructChunks(dst, src.Size(), options, [&](size_t chunk, size_t begin, size_t end, T* out) {
+        size_t i = begin;
+        try {
+            new (out) T(chunk == 0 ? data[begin] : op(*sums[chunk - 1], data[begin]));
+            for (++i; i < end; ++i) {
+                new (out + (i - begin)) T(op(out[i - begin - 1], data[i]));
+            }
+        } catch (...) {
+            std::destroy_n(out, i - begin);
+            throw;
+        }
+    });
+}
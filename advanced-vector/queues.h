@@ -0,0 +1,297 @@
+#pragma once
+
+#include "vector.h"
+#include "sharded_vector.h"
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+namespace queue_detail {
+
+inline size_t RoundUpToPowerOfTwo(size_t n) noexcept {
+    size_t result = 1;
+    while (result < n) {
+        result <<= 1;
+    }
+    return result;
+}
+
+}  // namespace queue_detail
+
+// Очередь без блокировок для одного производителя и одного потребителя.
+// Кольцевой буфер RawMemory с ёмкостью, равной степени двойки; индексы
+// головы и хвоста лежат в разных строках кэша. Каждая сторона кэширует
+// последний увиденный индекс другой стороны, чтобы реже читать чужую строку
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity)
+            : data_(queue_detail::RoundUpToPowerOfTwo(capacity))
+            , mask_(data_.Capacity() - 1) {
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    ~SpscQueue() {
+        size_t head = head_.load(std::memory_order_relaxed);
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        for (; head != tail; ++head) {
+            data_[head & mask_].~T();
+        }
+    }
+
+    size_t Capacity() const noexcept {
+        return data_.Capacity();
+    }
+
+    // Только для производителя. Возвращает false, если очередь заполнена
+    template <typename... Args>
+    bool TryEmplace(Args&&... args) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ == data_.Capacity()) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ == data_.Capacity()) {
+                return false;
+            }
+        }
+        new (data_ + (tail & mask_)) T(std::forward<Args>(args)...);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <typename S>
+    bool TryPush(S&& value) {
+        return TryEmplace(std::forward<S>(value));
+    }
+
+    // Только для производителя. Перемещает в очередь столько элементов
+    // из [first, first + count), сколько помещается, и публикует их разом
+    size_t TryPushBatch(T* first, size_t count) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t free = data_.Capacity() - (tail - cached_head_);
+        if (free < count) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            free = data_.Capacity() - (tail - cached_head_);
+        }
+        const size_t n = std::min(free, count);
+        size_t i = 0;
+        try {
+            for (; i < n; ++i) {
+                new (data_ + ((tail + i) & mask_)) T(std::move_if_noexcept(first[i]));
+            }
+        } catch (...) {
+            // Уже сконструированные элементы публикуются, чтобы не потерять их
+            tail_.store(tail + i, std::memory_order_release);
+            throw;
+        }
+        tail_.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+    // Только для потребителя. Возвращает false, если очередь пуста
+    bool TryPop(T& out) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) {
+                return false;
+            }
+        }
+        T& slot = data_[head & mask_];
+        out = std::move(slot);
+        slot.~T();
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Только для потребителя. Дописывает до max_count элементов в конец out
+    size_t TryPopBatch(Vector<T>& out, size_t max_count) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (cached_tail_ - head < max_count) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+        }
+        const size_t n = std::min(cached_tail_ - head, max_count);
+        if (n == 0) {
+            return 0;
+        }
+        out.AppendUninitialized(n, [this, head, n](T* dst) {
+            // Исключение при перемещении оставляет очередь нетронутой
+            for (size_t i = 0; i < n; ++i) {
+                try {
+                    new (dst + i) T(std::move_if_noexcept(data_[(head + i) & mask_]));
+                } catch (...) {
+                    std::destroy_n(dst, i);
+                    throw;
+                }
+            }
+            for (size_t i = 0; i < n; ++i) {
+                data_[(head + i) & mask_].~T();
+            }
+            return n;
+        });
+        head_.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    // Приблизительный размер: точен только в отсутствие параллельных операций
+    size_t Size() const noexcept {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+private:
+    RawMemory<T> data_;
+    const size_t mask_;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head_{0};
+    size_t cached_tail_ = 0;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail_{0};
+    size_t cached_head_ = 0;
+};
+
+// Ограниченная очередь без блокировок для многих производителей и потребителей
+// (схема Вьюкова): каждая ячейка кольца хранит номер последовательности,
+// по которому поток узнаёт, свободна ли ячейка для записи или готова к чтению
+template <typename T>
+class MpmcQueue {
+public:
+    explicit MpmcQueue(size_t capacity)
+            : cells_(queue_detail::RoundUpToPowerOfTwo(capacity))
+            , mask_(cells_.Capacity() - 1) {
+        for (size_t i = 0; i < cells_.Capacity(); ++i) {
+            new (cells_ + i) Cell(i);
+        }
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    ~MpmcQueue() {
+        size_t head = head_.load(std::memory_order_relaxed);
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        for (; head != tail; ++head) {
+            cells_[head & mask_].Value().~T();
+        }
+        std::destroy_n(cells_.GetAddress(), cells_.Capacity());
+    }
+
+    size_t Capacity() const noexcept {
+        return cells_.Capacity();
+    }
+
+    // Ячейка закрепляется за потоком до конструирования значения,
+    // поэтому конструктор не должен бросать исключений
+    template <typename... Args>
+    bool TryEmplace(Args&&... args) {
+        static_assert(std::is_nothrow_constructible_v<T, Args&&...>,
+                      "MpmcQueue requires a nothrow constructor for emplaced arguments");
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            const size_t seq = cell.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    new (cell.storage) T(std::forward<Args>(args)...);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    template <typename S>
+    bool TryPush(S&& value) {
+        return TryEmplace(std::forward<S>(value));
+    }
+
+    // Перемещает элементы из [first, first + count), пока в очереди есть место
+    size_t TryPushBatch(T* first, size_t count) {
+        size_t pushed = 0;
+        while (pushed < count && TryEmplace(std::move(first[pushed]))) {
+            ++pushed;
+        }
+        return pushed;
+    }
+
+    bool TryPop(T& out) noexcept {
+        size_t pos = 0;
+        Cell* cell = Claim(pos);
+        if (cell == nullptr) {
+            return false;
+        }
+        out = std::move(cell->Value());
+        Release(*cell, pos);
+        return true;
+    }
+
+    // Дописывает в конец out до max_count элементов
+    size_t TryPopBatch(Vector<T>& out, size_t max_count) {
+        // Память выделяется до захвата ячеек: после Claim бросать нельзя
+        return out.AppendUninitialized(max_count, [this, max_count](T* dst) noexcept {
+            size_t popped = 0;
+            for (; popped < max_count; ++popped) {
+                size_t pos = 0;
+                Cell* cell = Claim(pos);
+                if (cell == nullptr) {
+                    break;
+                }
+                new (dst + popped) T(std::move(cell->Value()));
+                Release(*cell, pos);
+            }
+            return popped;
+        });
+    }
+
+private:
+    static_assert(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>,
+                  "MpmcQueue requires nothrow move operations");
+
+    struct Cell {
+        explicit Cell(size_t seq) noexcept
+                : sequence(seq) {
+        }
+
+        T& Value() noexcept {
+            return *std::launder(reinterpret_cast<T*>(storage));
+        }
+
+        std::atomic<size_t> sequence;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    // Закрепляет за потоком готовую к чтению ячейку; её номер записывается в pos
+    Cell* Claim(size_t& pos) noexcept {
+        pos = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            const size_t seq = cell.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    return &cell;
+                }
+            } else if (diff < 0) {
+                return nullptr;
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Разрушает прочитанное значение и возвращает ячейку производителям
+    void Release(Cell& cell, size_t pos) noexcept {
+        cell.Value().~T();
+        cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+    }
+
+    RawMemory<Cell> cells_;
+    const size_t mask_;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head_{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail_{0};
+};
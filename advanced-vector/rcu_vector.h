@@ -0,0 +1,247 @@
+#pragma once
+
+#include "vector.h"
+#include "sharded_vector.h"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+// Вектор для сценария «много читателей, редкие записи».
+// Читатели получают неизменяемый снимок без блокировок: объявляют эпоху в своём
+// слоте и читают атомарный указатель на текущую версию. Писатель копирует данные,
+// изменяет копию и публикует её; старые версии освобождаются, когда ни один
+// читатель не может их видеть (освобождение на основе эпох)
+template <typename T>
+class RcuVector {
+    struct Version;
+
+public:
+    class Reader;
+
+    // Неизменяемый снимок содержимого. Пока снимок жив, версия не освобождается
+    class Snapshot {
+    public:
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+
+        Snapshot(Snapshot&& other) noexcept
+                : slot_(std::exchange(other.slot_, nullptr))
+                , version_(std::exchange(other.version_, nullptr)) {
+        }
+
+        Snapshot& operator=(Snapshot&&) = delete;
+
+        ~Snapshot() {
+            if (slot_ != nullptr) {
+                slot_->store(QUIESCENT, std::memory_order_release);
+            }
+        }
+
+        size_t Size() const noexcept {
+            return version_->data.Size();
+        }
+
+        const T& operator[](size_t index) const noexcept {
+            return version_->data[index];
+        }
+
+        const Vector<T>& Data() const noexcept {
+            return version_->data;
+        }
+
+        typename Vector<T>::const_iterator begin() const noexcept {
+            return version_->data.begin();
+        }
+
+        typename Vector<T>::const_iterator end() const noexcept {
+            return version_->data.end();
+        }
+
+    private:
+        friend class Reader;
+
+        Snapshot(std::atomic<uint64_t>* slot, const Version* version) noexcept
+                : slot_(slot)
+                , version_(version) {
+        }
+
+        std::atomic<uint64_t>* slot_;
+        const Version* version_;
+    };
+
+    // Регистрация потока-читателя. Каждый поток держит собственный Reader
+    // и одновременно не более одного снимка через него
+    class Reader {
+    public:
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        Reader(Reader&& other) noexcept
+                : owner_(std::exchange(other.owner_, nullptr))
+                , slot_(std::exchange(other.slot_, nullptr)) {
+        }
+
+        Reader& operator=(Reader&&) = delete;
+
+        ~Reader() {
+            if (slot_ != nullptr) {
+                slot_->store(FREE, std::memory_order_release);
+            }
+        }
+
+        // Без ожидания: одна запись в собственный слот и одно чтение указателя
+        Snapshot Read() const noexcept {
+            assert(slot_->load(std::memory_order_relaxed) == QUIESCENT);
+            slot_->store(owner_->epoch_.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+            const Version* version = owner_->current_.load(std::memory_order_seq_cst);
+            return Snapshot(slot_, version);
+        }
+
+    private:
+        friend class RcuVector;
+
+        Reader(const RcuVector* owner, std::atomic<uint64_t>* slot) noexcept
+                : owner_(owner)
+                , slot_(slot) {
+        }
+
+        const RcuVector* owner_;
+        std::atomic<uint64_t>* slot_;
+    };
+
+    explicit RcuVector(size_t max_readers = DEFAULT_MAX_READERS)
+            : RcuVector(Vector<T>{}, max_readers) {
+    }
+
+    explicit RcuVector(Vector<T> initial, size_t max_readers = DEFAULT_MAX_READERS)
+            : slots_(max_readers)
+            , current_(new Version{std::move(initial)}) {
+    }
+
+    RcuVector(const RcuVector&) = delete;
+    RcuVector& operator=(const RcuVector&) = delete;
+
+    // К моменту разрушения все читатели должны быть уничтожены
+    ~RcuVector() {
+        delete current_.load(std::memory_order_relaxed);
+        for (const Retired& retired : retired_) {
+            delete retired.version;
+        }
+    }
+
+    // Занимает свободный слот читателя; бросает std::length_error, если слотов нет
+    Reader RegisterReader() const {
+        for (auto& slot : slots_) {
+            uint64_t expected = FREE;
+            if (slot.epoch.compare_exchange_strong(expected, QUIESCENT, std::memory_order_acq_rel)) {
+                return Reader(this, &slot.epoch);
+            }
+        }
+        throw std::length_error("RcuVector: too many readers");
+    }
+
+    // Копирует текущую версию, применяет к копии f(Vector<T>&) и публикует результат
+    template <typename F>
+    void Update(F&& f) {
+        std::lock_guard guard(writer_mutex_);
+        Vector<T> copy(current_.load(std::memory_order_acquire)->data);
+        f(copy);
+        PublishLocked(std::move(copy));
+    }
+
+    // Публикует новое содержимое целиком
+    void Publish(Vector<T> data) {
+        std::lock_guard guard(writer_mutex_);
+        PublishLocked(std::move(data));
+    }
+
+    // Число старых версий, ожидающих освобождения
+    size_t PendingReclaim() const {
+        std::lock_guard guard(writer_mutex_);
+        return retired_.Size();
+    }
+
+    // Освобождает старые версии, которые больше не видит ни один читатель
+    void Reclaim() {
+        std::lock_guard guard(writer_mutex_);
+        ReclaimLocked();
+    }
+
+private:
+    static constexpr size_t DEFAULT_MAX_READERS = 128;
+    static constexpr uint64_t FREE = 0;
+    static constexpr uint64_t QUIESCENT = 1;
+    static constexpr uint64_t FIRST_EPOCH = 2;
+
+    struct Version {
+        Vector<T> data;
+    };
+
+    struct Retired {
+        const Version* version;
+        uint64_t epoch;
+    };
+
+    struct alignas(CACHE_LINE_SIZE) ReaderSlot {
+        std::atomic<uint64_t> epoch{FREE};
+
+        ReaderSlot() = default;
+
+        // Нужно только для размещения в Vector; слоты не перемещаются после создания
+        ReaderSlot(ReaderSlot&& other) noexcept
+                : epoch(other.epoch.load(std::memory_order_relaxed)) {
+        }
+    };
+
+    void PublishLocked(Vector<T> data) {
+        auto* next = new Version{std::move(data)};
+        const Version* previous = current_.exchange(next, std::memory_order_seq_cst);
+        // Читатель, объявивший эпоху позже этого инкремента, уже увидит next
+        const uint64_t epoch = epoch_.fetch_add(1, std::memory_order_seq_cst);
+        try {
+            retired_.PushBack(Retired{previous, epoch});
+        } catch (...) {
+            // Без места в списке остаётся только дождаться читателей старой версии
+            while (MinActiveEpoch() <= epoch) {
+                std::this_thread::yield();
+            }
+            delete previous;
+        }
+        ReclaimLocked();
+    }
+
+    uint64_t MinActiveEpoch() const noexcept {
+        uint64_t min_epoch = UINT64_MAX;
+        for (const auto& slot : slots_) {
+            const uint64_t epoch = slot.epoch.load(std::memory_order_seq_cst);
+            if (epoch >= FIRST_EPOCH && epoch < min_epoch) {
+                min_epoch = epoch;
+            }
+        }
+        return min_epoch;
+    }
+
+    void ReclaimLocked() noexcept {
+        const uint64_t min_epoch = MinActiveEpoch();
+        size_t kept = 0;
+        for (size_t i = 0; i < retired_.Size(); ++i) {
+            if (retired_[i].epoch < min_epoch) {
+                delete retired_[i].version;
+            } else {
+                retired_[kept++] = retired_[i];
+            }
+        }
+        while (retired_.Size() > kept) {
+            retired_.PopBack();
+        }
+    }
+
+    mutable Vector<ReaderSlot> slots_;
+    std::atomic<const Version*> current_;
+    std::atomic<uint64_t> epoch_{FIRST_EPOCH};
+    mutable std::mutex writer_mutex_;
+    Vector<Retired> retired_;
+};
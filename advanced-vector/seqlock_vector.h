@@ -0,0 +1,111 @@
+#pragma once
+
+#include "vector.h"
+#include "sharded_vector.h"
+
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+
+// Небольшой вектор тривиально копируемых элементов под защитой seqlock.
+// Единственный писатель делает счётчик версии нечётным на время записи.
+// Читатели копируют данные без атомарных операций чтения-модификации-записи
+// и повторяют копирование, если версия изменилась. Ёмкость фиксирована
+// при создании: буфер никогда не перевыделяется под читателями
+template <typename T>
+class SeqlockVector {
+    static_assert(std::is_trivially_copyable_v<T>, "SeqlockVector requires a trivially copyable type");
+
+public:
+    explicit SeqlockVector(size_t capacity)
+            : data_(capacity) {
+    }
+
+    SeqlockVector(const SeqlockVector&) = delete;
+    SeqlockVector& operator=(const SeqlockVector&) = delete;
+
+    size_t Capacity() const noexcept {
+        return data_.Capacity();
+    }
+
+    // Заменяет содержимое целиком. Только для писателя
+    void Store(const T* values, size_t count) {
+        if (count > data_.Capacity()) {
+            throw std::length_error("SeqlockVector: capacity exceeded");
+        }
+        Write([values, count](T* dst, size_t& size) {
+            std::memcpy(dst, values, count * sizeof(T));
+            size = count;
+        });
+    }
+
+    void Store(const Vector<T>& values) {
+        Store(values.begin(), values.Size());
+    }
+
+    // Изменяет элемент по индексу. Только для писателя
+    void Set(size_t index, const T& value) {
+        Write([index, &value](T* dst, size_t& size) {
+            assert(index < size);
+            dst[index] = value;
+        });
+    }
+
+    // Изменяет данные на месте: f(T* data, size_t& size), size не больше Capacity().
+    // Только для писателя; f не должна бросать исключений
+    template <typename F>
+    void Write(F&& f) noexcept {
+        const uint64_t seq = seq_.load(std::memory_order_relaxed);
+        seq_.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        size_t size = size_.load(std::memory_order_relaxed);
+        f(data_.GetAddress(), size);
+        assert(size <= data_.Capacity());
+        size_.store(size, std::memory_order_relaxed);
+        seq_.store(seq + 2, std::memory_order_release);
+    }
+
+    // Копирует согласованный снимок в out, переиспользуя его память
+    void Load(Vector<T>& out) const {
+        out.Clear();
+        out.Reserve(data_.Capacity());
+        out.AppendUninitialized(data_.Capacity(), [this](T* dst) {
+            return Load(dst);
+        });
+    }
+
+    Vector<T> Load() const {
+        Vector<T> result;
+        Load(result);
+        return result;
+    }
+
+    // Копирует согласованный снимок в dst (не меньше Capacity() элементов)
+    // и возвращает число скопированных элементов
+    size_t Load(T* dst) const noexcept {
+        for (;;) {
+            const uint64_t before = seq_.load(std::memory_order_acquire);
+            if ((before & 1) != 0) {
+                std::this_thread::yield();
+                continue;
+            }
+            const size_t size = size_.load(std::memory_order_relaxed);
+            std::memcpy(dst, data_.GetAddress(), size * sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq_.load(std::memory_order_relaxed) == before) {
+                return size;
+            }
+        }
+    }
+
+    size_t Size() const noexcept {
+        return size_.load(std::memory_order_acquire);
+    }
+
+private:
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> seq_{0};
+    std::atomic<size_t> size_{0};
+    RawMemory<T> data_;
+};
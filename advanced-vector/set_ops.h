@@ -0,0 +1,308 @@
+#pragma once
+
+#include "vector.h"
+#include "vector_compare.h"
+#include "external_sort.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Операции над множествами, заданными векторами целых чисел, отсортированными
+// по возрастанию без повторов (например, списки документов инвертированного
+// индекса). Результат дописывается в конец out прямо в неинициализированную
+// память: ёмкость резервируется один раз по верхней границе размера
+namespace set_ops_detail {
+
+// Во сколько раз один вектор должен быть длиннее другого, чтобы вместо
+// слияния искать каждый элемент короткого в длинном галопом
+inline constexpr size_t GALLOP_RATIO = 32;
+
+template <typename T>
+inline constexpr bool IS_SET_TYPE = std::is_integral_v<T> && !std::is_same_v<T, bool>;
+
+// Первая позиция в [first, last) со значением не меньше value. Шаги 1, 2, 4, ...
+// от first, затем двоичный поиск в найденном окне: O(log d), где d — расстояние
+// до ответа, поэтому проход по возрастающим value стоит O(m log(n / m))
+template <typename T>
+const T* Gallop(const T* first, const T* last, T value) noexcept {
+    const size_t size = static_cast<size_t>(last - first);
+    if (size == 0 || !(*first < value)) {
+        return first;
+    }
+    // first[step / 2] < value
+    size_t step = 1;
+    while (step < size && first[step] < value) {
+        step *= 2;
+    }
+    return std::lower_bound(first + step / 2 + 1, first + std::min(step, size), value);
+}
+
+template <typename M>
+ADVANCED_VECTOR_INLINE uint64_t LaneBits(const M& mask) noexcept {
+    constexpr size_t LANES = sizeof(M) / sizeof(mask[0]);
+    std::decay_t<decltype(mask[0])> lanes[LANES];
+    std::memcpy(lanes, &mask, sizeof(M));
+    uint64_t bits = 0;
+    for (size_t k = 0; k < LANES; ++k) {
+        bits |= static_cast<uint64_t>(lanes[k] != 0) << k;
+    }
+    return bits;
+}
+
+// Блочное пересечение: блок a из LANES элементов сравнивается со всеми LANES
+// элементами блока b за LANES векторных сравнений, затем сдвигается блок с
+// меньшим максимумом. Совпадения блока a накапливаются в маске, пока он не
+// сдвинется; тогда в out уходят совпавшие (KEEP_MATCHED) или несовпавшие элементы.
+// Возвращает число записанных
+template <typename T, size_t BYTES, bool KEEP_MATCHED>
+ADVANCED_VECTOR_INLINE size_t MatchKernel(const T* a, size_t n, const T* b, size_t m, T* out) noexcept {
+    using Lane = typename compare_detail::LaneType<T>::type;
+    using V = simd_detail::Simd<Lane, BYTES>;
+    constexpr size_t LANES = BYTES / sizeof(T);
+    size_t i = 0;
+    size_t j = 0;
+    size_t written = 0;
+    uint64_t matched = 0;
+    while (i + LANES <= n && j + LANES <= m) {
+        V va;
+        simd_detail::Load(va, a + i);
+        auto hits = va != va;
+        for (size_t k = 0; k < LANES; ++k) {
+            hits |= va == static_cast<Lane>(b[j + k]);
+        }
+        matched |= LaneBits(hits);
+        const T a_max = a[i + LANES - 1];
+        const T b_max = b[j + LANES - 1];
+        if (a_max <= b_max) {
+            for (size_t k = 0; k < LANES; ++k) {
+                if (((matched >> k) & 1) == KEEP_MATCHED) {
+                    out[written++] = a[i + k];
+                }
+            }
+            matched = 0;
+            i += LANES;
+        }
+        if (b_max <= a_max) {
+            j += LANES;
+        }
+    }
+    // Хвост слиянием. Элементы текущего блока a, совпавшие с уже пройденными
+    // блоками b, отмечены в matched
+    for (size_t k = 0; i < n; ++i, ++k) {
+        bool hit = k < LANES && ((matched >> k) & 1) != 0;
+        if (!hit) {
+            while (j < m && b[j] < a[i]) {
+                ++j;
+            }
+            hit = j < m && b[j] == a[i];
+        }
+        if (hit == KEEP_MATCHED) {
+            out[written++] = a[i];
+        }
+    }
+    return written;
+}
+
+template <typename T>
+struct BaselineSetKernels {
+    template <bool KEEP_MATCHED>
+    static size_t Match(const T* a, size_t n, const T* b, size_t m, T* out) noexcept {
+        return MatchKernel<T, 16, KEEP_MATCHED>(a, n, b, m, out);
+    }
+};
+
+#if ADVANCED_VECTOR_X86_DISPATCH
+
+template <typename T>
+struct Avx2SetKernels {
+    template <bool KEEP_MATCHED>
+    ADVANCED_VECTOR_TARGET("avx2") static size_t Match(const T* a, size_t n, const T* b, size_t m, T* out) noexcept {
+        return MatchKernel<T, 32, KEEP_MATCHED>(a, n, b, m, out);
+    }
+};
+
+template <typename T>
+struct Avx512SetKernels {
+    template <bool KEEP_MATCHED>
+    ADVANCED_VECTOR_TARGET("avx512f") static size_t Match(const T* a, size_t n, const T* b, size_t m, T* out) noexcept {
+        return MatchKernel<T, 64, KEEP_MATCHED>(a, n, b, m, out);
+    }
+};
+
+#endif  // ADVANCED_VECTOR_X86_DISPATCH
+
+template <bool KEEP_MATCHED, typename T>
+size_t Match(const T* a, size_t n, const T* b, size_t m, T* out) noexcept {
+#if ADVANCED_VECTOR_X86_DISPATCH
+    const SimdLevel level = DetectSimdLevel();
+    if (level == SimdLevel::AVX512) {
+        return Avx512SetKernels<T>::template Match<KEEP_MATCHED>(a, n, b, m, out);
+    }
+    if (level == SimdLevel::AVX2) {
+        return Avx2SetKernels<T>::template Match<KEEP_MATCHED>(a, n, b, m, out);
+    }
+#endif
+    return BaselineSetKernels<T>::template Match<KEEP_MATCHED>(a, n, b, m, out);
+}
+
+// Элементы a, которые есть (KEEP_MATCHED) или которых нет в намного более длинном b
+template <bool KEEP_MATCHED, typename T>
+size_t GallopMatch(const T* a, size_t n, const T* b, size_t m, T* out) noexcept {
+    const T* position = b;
+    const T* const last = b + m;
+    size_t written = 0;
+    for (size_t i = 0; i < n; ++i) {
+        position = Gallop(position, last, a[i]);
+        const bool hit = position != last && *position == a[i];
+        if (hit == KEEP_MATCHED) {
+            out[written++] = a[i];
+        }
+    }
+    return written;
+}
+
+// Сливает намного более длинный large с small: участки large между
+// элементами small копируются целиком, и std::copy сводит их к memmove.
+// Если SKIP_EQUAL, элементы small, найденные в large, пропускаются
+// (разность large \ small), иначе пишутся один раз (объединение)
+template <bool SKIP_EQUAL, typename T>
+size_t GallopMerge(const T* large, size_t n, const T* small, size_t m, T* out) noexcept {
+    const T* position = large;
+    const T* const last = large + n;
+    size_t written = 0;
+    for (size_t j = 0; j < m; ++j) {
+        const T* next = Gallop(position, last, small[j]);
+        written = static_cast<size_t>(std::copy(position, next, out + written) - out);
+        position = next;
+        const bool found = position != last && *position == small[j];
+        if (found) {
+            ++position;
+        }
+        if (!SKIP_EQUAL) {
+            out[written++] = small[j];
+        }
+    }
+    return static_cast<size_t>(std::copy(position, last, out + written) - out);
+}
+
+template <typename T>
+bool IsSet(const Vector<T>& v) noexcept {
+    return std::adjacent_find(v.begin(), v.end(), [](T lhs, T rhs) {
+               return !(lhs < rhs);
+           }) == v.end();
+}
+
+}  // namespace set_ops_detail
+
+// a ∩ b. Векторы близкой длины пересекаются блоками в векторных регистрах,
+// при разнице в GALLOP_RATIO раз и больше короткий ищется в длинном галопом
+template <typename T>
+void SetIntersection(const Vector<T>& a, const Vector<T>& b, Vector<T>& out) {
+    using namespace set_ops_detail;
+    static_assert(IS_SET_TYPE<T>, "SetIntersection requires an integer type");
+    assert(IsSet(a) && IsSet(b));
+    const Vector<T>& small = a.Size() <= b.Size() ? a : b;
+    const Vector<T>& large = a.Size() <= b.Size() ? b : a;
+    if (small.Size() == 0) {
+        return;
+    }
+    out.AppendUninitialized(small.Size(), [&small, &large](T* dst) {
+        if (large.Size() / small.Size() >= GALLOP_RATIO) {
+            return GallopMatch<true>(small.begin(), small.Size(), large.begin(), large.Size(), dst);
+        }
+        return Match<true>(small.begin(), small.Size(), large.begin(), large.Size(), dst);
+    });
+}
+
+// a \ b
+template <typename T>
+void SetDifference(const Vector<T>& a, const Vector<T>& b, Vector<T>& out) {
+    using namespace set_ops_detail;
+    static_assert(IS_SET_TYPE<T>, "SetDifference requires an integer type");
+    assert(IsSet(a) && IsSet(b));
+    if (a.Size() == 0) {
+        return;
+    }
+    out.AppendUninitialized(a.Size(), [&a, &b](T* dst) {
+        if (b.Size() / a.Size() >= GALLOP_RATIO) {
+            return GallopMatch<false>(a.begin(), a.Size(), b.begin(), b.Size(), dst);
+        }
+        if (b.Size() == 0 || a.Size() / b.Size() >= GALLOP_RATIO) {
+            return GallopMerge<true>(a.begin(), a.Size(), b.begin(), b.Size(), dst);
+        }
+        return Match<false>(a.begin(), a.Size(), b.begin(), b.Size(), dst);
+    });
+}
+
+// a ∪ b
+template <typename T>
+void SetUnion(const Vector<T>& a, const Vector<T>& b, Vector<T>& out) {
+    using namespace set_ops_detail;
+    static_assert(IS_SET_TYPE<T>, "SetUnion requires an integer type");
+    assert(IsSet(a) && IsSet(b));
+    const Vector<T>& small = a.Size() <= b.Size() ? a : b;
+    const Vector<T>& large = a.Size() <= b.Size() ? b : a;
+    out.AppendUninitialized(a.Size() + b.Size(), [&small, &large](T* dst) {
+        if (small.Size() == 0 || large.Size() / small.Size() >= GALLOP_RATIO) {
+            return GallopMerge<false>(large.begin(), large.Size(), small.begin(), small.Size(), dst);
+        }
+        const T* x = small.begin();
+        const T* const x_end = small.end();
+        const T* y = large.begin();
+        const T* const y_end = large.end();
+        size_t written = 0;
+        while (x != x_end && y != y_end) {
+            const T value = *x < *y ? *x : *y;
+            x += !(value < *x);
+            y += !(value < *y);
+            dst[written++] = value;
+        }
+        T* tail = std::copy(x, x_end, dst + written);
+        return static_cast<size_t>(std::copy(y, y_end, tail) - dst);
+    });
+}
+
+// Слияние k отсортированных векторов в один с сохранением повторов; равные
+// элементы идут в порядке номеров векторов. Размер результата известен
+// заранее, поэтому он пишется одним проходом дерева проигравших
+template <typename Range, typename T>
+void MergeK(const Range& lists, Vector<T>& out) {
+    using namespace set_ops_detail;
+    static_assert(IS_SET_TYPE<T>, "MergeK requires an integer type");
+    Vector<const T*> heads;
+    Vector<const T*> ends;
+    size_t total = 0;
+    for (const Vector<T>& list : lists) {
+        assert(std::is_sorted(list.begin(), list.end()));
+        if (list.Size() != 0) {
+            heads.PushBack(list.begin());
+            ends.PushBack(list.end());
+            total += list.Size();
+        }
+    }
+    if (total == 0) {
+        return;
+    }
+    out.AppendUninitialized(total, [&heads, &ends, total](T* dst) {
+        if (heads.Size() == 1) {
+            std::copy(heads[0], ends[0], dst);
+        } else if (heads.Size() == 2) {
+            std::merge(heads[0], ends[0], heads[1], ends[1], dst);
+        } else {
+            auto less = [&heads, &ends](size_t a, size_t b) {
+                if (heads[a] == ends[a] || heads[b] == ends[b]) {
+                    return heads[a] != ends[a] && (heads[b] == ends[b] || a < b);
+                }
+                return *heads[a] < *heads[b] || (!(*heads[b] < *heads[a]) && a < b);
+            };
+            external_sort_detail::LoserTree tree(heads.Size(), less);
+            for (size_t written = 0; written < total; ++written) {
+                dst[written] = *heads[tree.Winner()]++;
+                tree.Replay(less);
+            }
+        }
+        return total;
+    });
+}
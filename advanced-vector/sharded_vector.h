@@ -0,0 +1,147 @@
+#pragma once
+
+#include "vector.h"
+
+#include <cstddef>
+#include <thread>
+#include <type_traits>
+
+// Размер строки кэша, по которому выравниваются заголовки шардов,
+// чтобы потоки, пишущие в соседние шарды, не делили одну строку
+inline constexpr size_t CACHE_LINE_SIZE = 64;
+
+// Вектор, разбитый на шарды: каждый поток пишет в свой шард по индексу,
+// поэтому EmplaceBack не требует синхронизации. Результаты собираются
+// методом Gather одной аллокацией либо обходятся на месте через ForEach
+template <typename T>
+class ShardedVector {
+public:
+    explicit ShardedVector(size_t shard_count)
+            : shards_(shard_count)
+    {
+        assert(shard_count != 0);
+    }
+
+    // Вызывать из потока, владеющего шардом shard
+    template <typename... Args>
+    T& EmplaceBack(size_t shard, Args&&... args) {
+        return shards_[shard].data.EmplaceBack(std::forward<Args>(args)...);
+    }
+
+    template <typename S>
+    void PushBack(size_t shard, S&& value) {
+        EmplaceBack(shard, std::forward<S>(value));
+    }
+
+    Vector<T>& Shard(size_t shard) noexcept {
+        return shards_[shard].data;
+    }
+
+    const Vector<T>& Shard(size_t shard) const noexcept {
+        return shards_[shard].data;
+    }
+
+    size_t ShardCount() const noexcept {
+        return shards_.Size();
+    }
+
+    // Суммарное число элементов. Нельзя вызывать одновременно с записью
+    size_t Size() const noexcept {
+        size_t total = 0;
+        for (const auto& shard : shards_) {
+            total += shard.data.Size();
+        }
+        return total;
+    }
+
+    // Обходит элементы всех шардов по порядку без их объединения
+    template <typename F>
+    void ForEach(F&& f) {
+        for (auto& shard : shards_) {
+            for (T& value : shard.data) {
+                f(value);
+            }
+        }
+    }
+
+    template <typename F>
+    void ForEach(F&& f) const {
+        for (const auto& shard : shards_) {
+            for (const T& value : shard.data) {
+                f(value);
+            }
+        }
+    }
+
+    // Переносит содержимое шардов в один Vector, выделяя память один раз.
+    // Для типов с небросающим перемещением крупные шарды переносятся параллельно.
+    // Шарды после вызова пусты, но сохраняют свою ёмкость
+    Vector<T> Gather() {
+        Vector<T> result;
+        const size_t total = Size();
+        result.Reserve(total);
+        result.AppendUninitialized(total, [this, total](T* dst) {
+            if constexpr (std::is_nothrow_move_constructible_v<T>) {
+                if (total >= PARALLEL_GATHER_THRESHOLD && shards_.Size() > 1) {
+                    RelocateParallel(dst);
+                    return total;
+                }
+            }
+            RelocateSequential(dst);
+            return total;
+        });
+        for (auto& shard : shards_) {
+            shard.data.Clear();
+        }
+        return result;
+    }
+
+private:
+    static constexpr size_t PARALLEL_GATHER_THRESHOLD = 1 << 16;
+
+    struct alignas(CACHE_LINE_SIZE) PaddedShard {
+        Vector<T> data;
+    };
+
+    void RelocateSequential(T* dst) {
+        size_t done = 0;
+        try {
+            for (auto& shard : shards_) {
+                if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
+                    std::uninitialized_move_n(shard.data.begin(), shard.data.Size(), dst + done);
+                } else {
+                    std::uninitialized_copy_n(shard.data.begin(), shard.data.Size(), dst + done);
+                }
+                done += shard.data.Size();
+            }
+        } catch (...) {
+            std::destroy_n(dst, done);
+            throw;
+        }
+    }
+
+    void RelocateParallel(T* dst) {
+        Vector<std::thread> workers;
+        workers.Reserve(shards_.Size() - 1);
+        size_t offset = shards_[0].data.Size();
+        for (size_t i = 1; i < shards_.Size(); ++i) {
+            Vector<T>& shard = shards_[i].data;
+            auto relocate = [&shard, to = dst + offset] {
+                std::uninitialized_move_n(shard.begin(), shard.Size(), to);
+            };
+            try {
+                workers.EmplaceBack(relocate);
+            } catch (...) {
+                // Не удалось запустить поток: переносим шард в текущем
+                relocate();
+            }
+            offset += shard.Size();
+        }
+        std::uninitialized_move_n(shards_[0].data.begin(), shards_[0].data.Size(), dst);
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    Vector<PaddedShard> shards_;
+};
@@ -0,0 +1,339 @@
+#pragma once
+
+#include "vector.h"
+#include "file_io.h"
+#include "sharded_vector.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace shm_detail {
+
+inline constexpr uint64_t MAGIC = 0x5348'4D56'4543'0001;  // "SHMVEC", версия формата 1
+
+// Сколько читатель ждёт согласованного снимка. Дольше буфер остаётся
+// занятым, только если писатель завершился посреди записи
+inline constexpr std::chrono::seconds READ_TIMEOUT{1};
+
+// Один из двух буферов данных. Смещение отсчитывается от начала сегмента,
+// поэтому сегмент можно отображать по разным адресам в разных процессах
+struct alignas(CACHE_LINE_SIZE) Slot {
+    // Нечётное значение — писатель изменяет буфер
+    std::atomic<uint64_t> seq;
+    std::atomic<uint64_t> size;
+    uint64_t data_offset;
+};
+
+// Заголовок в начале сегмента
+struct Header {
+    // Записывается последним: ненулевое значение означает, что заголовок заполнен
+    std::atomic<uint64_t> magic;
+    uint64_t element_size;
+    uint64_t element_align;
+    uint64_t capacity;
+    // Число публикаций; опубликован буфер slots[version & 1]
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> version;
+    Slot slots[2];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared memory requires address-free atomics");
+
+inline size_t AlignUp(size_t value, size_t alignment) noexcept {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// Наибольшая ёмкость, при которой заголовок, два буфера и выравнивание
+// между ними помещаются в off_t
+inline size_t MaxCapacity(size_t element_size, size_t header_bytes, size_t alignment) noexcept {
+    const auto max_bytes = static_cast<size_t>(std::numeric_limits<off_t>::max());
+    return (max_bytes - header_bytes - alignment) / 2 / element_size;
+}
+
+}  // namespace shm_detail
+
+// Вектор тривиально копируемых элементов в разделяемой памяти POSIX.
+// Процесс-писатель создаёт сегмент (Create), читатели открывают его по имени
+// (Open) и читают данные на месте, без сокетов и сериализации.
+// В сегменте два буфера: писатель заполняет неопубликованный и затем
+// публикует его увеличением версии. Каждый буфер защищён своим seqlock,
+// так что читатели повторяют чтение, только если писатель успел сделать
+// две публикации за время одного чтения. Ёмкость фиксирована при создании
+template <typename T>
+class ShmVector {
+    static_assert(std::is_trivially_copyable_v<T>, "ShmVector requires a trivially copyable type");
+
+public:
+    // Создаёт новый сегмент name (например, "/prices") на capacity элементов.
+    // Бросает std::system_error, если сегмент уже существует, и
+    // std::length_error, если размер сегмента не представим
+    static ShmVector Create(const std::string& name, size_t capacity) {
+        using namespace shm_detail;
+        const size_t alignment = std::max(alignof(T), CACHE_LINE_SIZE);
+        const size_t first = AlignUp(sizeof(Header), alignment);
+        if (capacity > MaxCapacity(sizeof(T), first, alignment)) {
+            throw std::length_error("ShmVector: capacity is too large");
+        }
+        const size_t second = AlignUp(first + capacity * sizeof(T), alignment);
+        const size_t total = second + capacity * sizeof(T);
+
+        const int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0) {
+            io_detail::ThrowErrno("shm_open");
+        }
+        if (::ftruncate(fd, static_cast<off_t>(total)) != 0) {
+            const int error = errno;
+            ::close(fd);
+            ::shm_unlink(name.c_str());
+            errno = error;
+            io_detail::ThrowErrno("ftruncate");
+        }
+        ShmVector result = [&] {
+            try {
+                return ShmVector(fd, total, true);
+            } catch (...) {
+                ::shm_unlink(name.c_str());
+                throw;
+            }
+        }();
+        Header* header = new (result.base_) Header{};
+        header->element_size = sizeof(T);
+        header->element_align = alignof(T);
+        header->capacity = capacity;
+        header->slots[0].data_offset = first;
+        header->slots[1].data_offset = second;
+        header->magic.store(MAGIC, std::memory_order_release);
+        return result;
+    }
+
+    // Открывает существующий сегмент только для чтения. Бросает
+    // std::system_error при ошибке системы и std::runtime_error, если
+    // сегмент ещё не заполнен или создан для другого типа элементов
+    static ShmVector Open(const std::string& name) {
+        using namespace shm_detail;
+        const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            io_detail::ThrowErrno("shm_open");
+        }
+        struct stat st{};
+        if (::fstat(fd, &st) != 0) {
+            const int error = errno;
+            ::close(fd);
+            errno = error;
+            io_detail::ThrowErrno("fstat");
+        }
+        if (static_cast<size_t>(st.st_size) < sizeof(Header)) {
+            ::close(fd);
+            throw std::runtime_error("ShmVector: segment is not initialized");
+        }
+        ShmVector result(fd, static_cast<size_t>(st.st_size), false);
+        const Header& header = result.GetHeader();
+        if (header.magic.load(std::memory_order_acquire) != MAGIC) {
+            throw std::runtime_error("ShmVector: segment is not initialized");
+        }
+        if (header.element_size != sizeof(T) || header.element_align != alignof(T)) {
+            throw std::runtime_error("ShmVector: element type mismatch");
+        }
+        // Поля заголовка не доверенные: проверки записаны без переполнений
+        for (const Slot& slot : header.slots) {
+            if (slot.data_offset > result.mapped_size_
+                || header.capacity > (result.mapped_size_ - slot.data_offset) / sizeof(T)) {
+                throw std::runtime_error("ShmVector: segment is truncated");
+            }
+        }
+        return result;
+    }
+
+    // Удаляет имя сегмента. Уже открытые отображения остаются действительными
+    static void Unlink(const std::string& name) {
+        if (::shm_unlink(name.c_str()) != 0) {
+            io_detail::ThrowErrno("shm_unlink");
+        }
+    }
+
+    ShmVector(const ShmVector&) = delete;
+    ShmVector& operator=(const ShmVector&) = delete;
+
+    ShmVector(ShmVector&& other) noexcept
+            : fd_(std::exchange(other.fd_, -1))
+            , base_(std::exchange(other.base_, nullptr))
+            , mapped_size_(std::exchange(other.mapped_size_, 0))
+            , writable_(other.writable_) {
+    }
+
+    ShmVector& operator=(ShmVector&& rhs) noexcept {
+        std::swap(fd_, rhs.fd_);
+        std::swap(base_, rhs.base_);
+        std::swap(mapped_size_, rhs.mapped_size_);
+        std::swap(writable_, rhs.writable_);
+        return *this;
+    }
+
+    ~ShmVector() {
+        if (base_ != nullptr) {
+            ::munmap(base_, mapped_size_);
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    size_t Capacity() const noexcept {
+        return GetHeader().capacity;
+    }
+
+    // Число публикаций с момента создания сегмента
+    uint64_t Version() const noexcept {
+        return GetHeader().version.load(std::memory_order_acquire);
+    }
+
+    size_t Size() const noexcept {
+        const shm_detail::Header& header = GetHeader();
+        return header.slots[header.version.load(std::memory_order_acquire) & 1].size.load(std::memory_order_relaxed);
+    }
+
+    // Публикует новое содержимое целиком. Только для писателя
+    void Store(const T* values, size_t count) {
+        if (count > Capacity()) {
+            throw std::length_error("ShmVector: capacity exceeded");
+        }
+        Publish([values, count](T* dst, size_t& size) {
+            std::memcpy(static_cast<void*>(dst), values, count * sizeof(T));
+            size = count;
+        });
+    }
+
+    void Store(const Vector<T>& values) {
+        Store(values.begin(), values.Size());
+    }
+
+    // Публикует изменённую копию текущего содержимого: f(T* data, size_t& size),
+    // size не больше Capacity(). Только для писателя; f не должна бросать исключений
+    template <typename F>
+    void Update(F&& f) noexcept {
+        Publish([this, &f](T* dst, size_t& size) {
+            const shm_detail::Header& header = GetHeader();
+            const shm_detail::Slot& current = header.slots[header.version.load(std::memory_order_relaxed) & 1];
+            size = current.size.load(std::memory_order_relaxed);
+            std::memcpy(static_cast<void*>(dst), SlotData(current), size * sizeof(T));
+            f(dst, size);
+        });
+    }
+
+    // Читает опубликованные данные на месте: f(const T* data, size_t size).
+    // Если писатель затёр буфер во время чтения, f вызывается повторно для
+    // новой версии, поэтому f должна только читать и терпеть несогласованные
+    // данные в отброшенных попытках. Возвращает версию, которую видела f.
+    // Бросает std::runtime_error, если за READ_TIMEOUT согласованный снимок
+    // так и не прочитан: значит, писатель завершился, не закончив запись
+    template <typename F>
+    uint64_t Read(F&& f) const {
+        const shm_detail::Header& header = GetHeader();
+        std::optional<std::chrono::steady_clock::time_point> deadline;
+        for (;;) {
+            const uint64_t version = header.version.load(std::memory_order_acquire);
+            const shm_detail::Slot& slot = header.slots[version & 1];
+            const uint64_t before = slot.seq.load(std::memory_order_acquire);
+            if ((before & 1) == 0) {
+                const size_t size = std::min<size_t>(slot.size.load(std::memory_order_relaxed), header.capacity);
+                f(static_cast<const T*>(SlotData(slot)), size);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.seq.load(std::memory_order_relaxed) == before) {
+                    return version;
+                }
+            }
+            RetryRead(deadline);
+        }
+    }
+
+    // Копирует согласованный снимок в out, переиспользуя его память
+    uint64_t Load(Vector<T>& out) const {
+        out.Clear();
+        out.Reserve(Capacity());
+        uint64_t version = 0;
+        out.AppendUninitialized(Capacity(), [this, &version](T* dst) {
+            size_t count = 0;
+            version = Read([dst, &count](const T* data, size_t size) {
+                std::memcpy(static_cast<void*>(dst), data, size * sizeof(T));
+                count = size;
+            });
+            return count;
+        });
+        return version;
+    }
+
+    Vector<T> Load() const {
+        Vector<T> result;
+        Load(result);
+        return result;
+    }
+
+private:
+    ShmVector(int fd, size_t size, bool writable)
+            : fd_(fd)
+            , mapped_size_(size)
+            , writable_(writable) {
+        void* base = ::mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+        if (base == MAP_FAILED) {
+            const int error = errno;
+            ::close(fd_);
+            errno = error;
+            io_detail::ThrowErrno("mmap");
+        }
+        base_ = base;
+    }
+
+    // Отсчёт времени начинается с первой неудачной попытки
+    static void RetryRead(std::optional<std::chrono::steady_clock::time_point>& deadline) {
+        const auto now = std::chrono::steady_clock::now();
+        if (!deadline) {
+            deadline = now + shm_detail::READ_TIMEOUT;
+        } else if (now > *deadline) {
+            throw std::runtime_error("ShmVector: writer did not finish publishing");
+        }
+        std::this_thread::yield();
+    }
+
+    shm_detail::Header& GetHeader() const noexcept {
+        return *static_cast<shm_detail::Header*>(base_);
+    }
+
+    T* SlotData(const shm_detail::Slot& slot) const noexcept {
+        return reinterpret_cast<T*>(static_cast<char*>(base_) + slot.data_offset);
+    }
+
+    // Заполняет неопубликованный буфер под его seqlock и публикует его
+    template <typename F>
+    void Publish(F&& fill) noexcept {
+        assert(writable_);
+        shm_detail::Header& header = GetHeader();
+        const uint64_t version = header.version.load(std::memory_order_relaxed);
+        shm_detail::Slot& slot = header.slots[(version + 1) & 1];
+        const uint64_t seq = slot.seq.load(std::memory_order_relaxed);
+        slot.seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        size_t size = 0;
+        fill(SlotData(slot), size);
+        assert(size <= header.capacity);
+        slot.size.store(size, std::memory_order_relaxed);
+        slot.seq.store(seq + 2, std::memory_order_release);
+        header.version.store(version + 1, std::memory_order_release);
+    }
+
+    int fd_ = -1;
+    void* base_ = nullptr;
+    size_t mapped_size_ = 0;
+    bool writable_ = false;
+};
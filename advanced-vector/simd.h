@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+
+// Общая основа ядер на векторных расширениях GCC/Clang (blas.h,
+// vector_compare.h, set_ops.h): один и тот же шаблон компилируется под
+// нужную ширину регистра внутри функции с атрибутом target, а набор
+// инструкций выбирается при выполнении
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ADVANCED_VECTOR_X86_DISPATCH 1
+#define ADVANCED_VECTOR_TARGET(isa) __attribute__((target(isa)))
+#else
+#define ADVANCED_VECTOR_X86_DISPATCH 0
+#define ADVANCED_VECTOR_TARGET(isa)
+#endif
+
+#define ADVANCED_VECTOR_INLINE __attribute__((always_inline)) inline
+
+// Набор векторных инструкций для ядер
+enum class SimdLevel {
+    BASELINE,
+    AVX2,
+    AVX512,
+};
+
+// Лучший набор инструкций, который поддерживают процессор и ОС.
+// Определяется один раз при первом вызове
+inline SimdLevel DetectSimdLevel() noexcept {
+#if ADVANCED_VECTOR_X86_DISPATCH
+    static const SimdLevel level = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) {
+            return SimdLevel::AVX512;
+        }
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+            return SimdLevel::AVX2;
+        }
+        return SimdLevel::BASELINE;
+    }();
+    return level;
+#else
+    return SimdLevel::BASELINE;
+#endif
+}
+
+namespace simd_detail {
+
+template <typename T, size_t BYTES>
+struct SimdType {
+    typedef T type __attribute__((vector_size(BYTES)));
+};
+
+template <typename T, size_t BYTES>
+using Simd = typename SimdType<T, BYTES>::type;
+
+// Векторы передаются между вспомогательными функциями только по ссылке:
+// передача по значению зависела бы от ABI набора инструкций
+
+template <typename V, typename T>
+ADVANCED_VECTOR_INLINE void Load(V& out, const T* data) noexcept {
+    std::memcpy(&out, data, sizeof(V));
+}
+
+template <typename V, typename T>
+ADVANCED_VECTOR_INLINE void Store(T* data, const V& v) noexcept {
+    std::memcpy(data, &v, sizeof(V));
+}
+
+}  // namespace simd_detail
@@ -0,0 +1,232 @@
+#pragma once
+
+#include "vector.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+
+namespace sort_detail {
+
+inline constexpr size_t NETWORK_MAX_SIZE = 8;
+inline constexpr size_t RADIX_MIN_SIZE = 256;
+inline constexpr size_t RADIX_BUCKETS = 256;
+
+template <typename T, typename Compare>
+void CompareExchange(T* data, size_t i, size_t j, Compare& comp) {
+    if (comp(data[j], data[i])) {
+        std::swap(data[i], data[j]);
+    }
+}
+
+// Оптимальные по числу сравнений сети сортировки для 2..8 элементов
+template <typename T, typename Compare>
+void SortNetwork(T* d, size_t n, Compare comp) {
+    auto cx = [d, &comp](size_t i, size_t j) {
+        CompareExchange(d, i, j, comp);
+    };
+    switch (n) {
+        case 0:
+        case 1:
+            return;
+        case 2:
+            cx(0, 1);
+            return;
+        case 3:
+            cx(1, 2); cx(0, 2); cx(0, 1);
+            return;
+        case 4:
+            cx(0, 1); cx(2, 3); cx(0, 2); cx(1, 3); cx(1, 2);
+            return;
+        case 5:
+            cx(0, 1); cx(3, 4); cx(2, 4); cx(2, 3); cx(0, 3);
+            cx(0, 2); cx(1, 4); cx(1, 3); cx(1, 2);
+            return;
+        case 6:
+            cx(1, 2); cx(0, 2); cx(0, 1); cx(4, 5); cx(3, 5); cx(3, 4);
+            cx(0, 3); cx(1, 4); cx(2, 5); cx(2, 4); cx(1, 3); cx(2, 3);
+            return;
+        case 7:
+            cx(1, 2); cx(0, 2); cx(0, 1); cx(3, 4); cx(5, 6); cx(3, 5);
+            cx(4, 6); cx(4, 5); cx(0, 4); cx(0, 3); cx(1, 5); cx(2, 6);
+            cx(2, 5); cx(1, 3); cx(2, 4); cx(2, 3);
+            return;
+        case 8:
+            cx(0, 1); cx(2, 3); cx(0, 2); cx(1, 3); cx(1, 2); cx(4, 5);
+            cx(6, 7); cx(4, 6); cx(5, 7); cx(5, 6); cx(0, 4); cx(1, 5);
+            cx(1, 4); cx(2, 6); cx(3, 7); cx(3, 6); cx(2, 4); cx(3, 5);
+            cx(3, 4);
+            return;
+        default:
+            assert(false && "Sorting network supports at most 8 elements");
+    }
+}
+
+// Отображает ключ в беззнаковое целое с тем же порядком
+template <typename K>
+auto ToRadixKey(K key) noexcept {
+    static_assert(std::is_arithmetic_v<K>, "Radix key must be an integer or floating-point type");
+    if constexpr (std::is_same_v<K, bool>) {
+        return static_cast<uint8_t>(key);
+    } else if constexpr (std::is_integral_v<K>) {
+        using U = std::make_unsigned_t<K>;
+        if constexpr (std::is_signed_v<K>) {
+            return static_cast<U>(static_cast<U>(key) ^ (U{1} << (sizeof(U) * 8 - 1)));
+        } else {
+            return static_cast<U>(key);
+        }
+    } else {
+        static_assert(sizeof(K) == 4 || sizeof(K) == 8, "Unsupported floating-point type");
+        using U = std::conditional_t<sizeof(K) == 4, uint32_t, uint64_t>;
+        U bits;
+        std::memcpy(&bits, &key, sizeof(K));
+        constexpr U SIGN = U{1} << (sizeof(U) * 8 - 1);
+        // Отрицательные числа инвертируются целиком, у положительных взводится знаковый бит
+        return static_cast<U>((bits & SIGN) != 0 ? ~bits : bits | SIGN);
+    }
+}
+
+}  // namespace sort_detail
+
+// Поразрядная сортировка LSD по байтам ключа key(element), который должен быть
+// целым или вещественным числом. Сортировка устойчива. Проходы, в которых все
+// ключи имеют одинаковый байт, пропускаются. Использует вспомогательный буфер
+// RawMemory того же размера, поэтому требует тривиально копируемого T
+template <typename T, typename KeyFn>
+void RadixSortBy(Vector<T>& v, KeyFn key) {
+    static_assert(std::is_trivially_copyable_v<T>, "RadixSortBy requires a trivially copyable type");
+    using Key = decltype(sort_detail::ToRadixKey(key(std::declval<const T&>())));
+    constexpr size_t PASSES = sizeof(Key);
+    const size_t n = v.Size();
+    if (n < sort_detail::RADIX_MIN_SIZE) {
+        std::stable_sort(v.begin(), v.end(), [&key](const T& lhs, const T& rhs) {
+            return sort_detail::ToRadixKey(key(lhs)) < sort_detail::ToRadixKey(key(rhs));
+        });
+        return;
+    }
+
+    // Гистограммы всех байтов строятся за один проход по данным
+    Vector<size_t> counts(PASSES * sort_detail::RADIX_BUCKETS);
+    for (const T& value : v) {
+        const Key k = sort_detail::ToRadixKey(key(value));
+        for (size_t pass = 0; pass < PASSES; ++pass) {
+            ++counts[pass * sort_detail::RADIX_BUCKETS + ((k >> (pass * 8)) & 0xFF)];
+        }
+    }
+
+    RawMemory<T> buffer(n);
+    T* src = v.begin();
+    T* dst = buffer.GetAddress();
+    for (size_t pass = 0; pass < PASSES; ++pass) {
+        size_t* count = &counts[pass * sort_detail::RADIX_BUCKETS];
+        const Key first_byte = (sort_detail::ToRadixKey(key(src[0])) >> (pass * 8)) & 0xFF;
+        if (count[first_byte] == n) {
+            continue;
+        }
+        size_t offset = 0;
+        for (size_t bucket = 0; bucket < sort_detail::RADIX_BUCKETS; ++bucket) {
+            offset += std::exchange(count[bucket], offset);
+        }
+        for (size_t i = 0; i < n; ++i) {
+            const size_t bucket = (sort_detail::ToRadixKey(key(src[i])) >> (pass * 8)) & 0xFF;
+            std::memcpy(static_cast<void*>(dst + count[bucket]++), &src[i], sizeof(T));
+        }
+        std::swap(src, dst);
+    }
+    if (src != v.begin()) {
+        std::memcpy(static_cast<void*>(v.begin()), src, n * sizeof(T));
+    }
+}
+
+// Поразрядная сортировка вектора целых или вещественных чисел по возрастанию
+template <typename T>
+void RadixSort(Vector<T>& v) {
+    static_assert(std::is_arithmetic_v<T>, "RadixSort requires an integer or floating-point type");
+    RadixSortBy(v, [](T value) {
+        return value;
+    });
+}
+
+// Параллельная сортировка слиянием: блоки сортируются в пуле потоков,
+// затем попарно сливаются через вспомогательный буфер, пока не останется один блок
+template <typename T, typename Compare = std::less<>>
+void ParallelMergeSort(Vector<T>& v, Compare comp = {}, const ParallelOptions& options = {}) {
+    const size_t n = v.Size();
+    ThreadPool& pool = options.pool != nullptr ? *options.pool : DefaultThreadPool();
+    const size_t threads = pool.ThreadCount();
+    size_t run = std::max<size_t>((n + threads - 1) / std::max<size_t>(threads, 1), 1);
+    if (options.grain_size != 0) {
+        run = options.grain_size;
+    }
+    if (n <= run) {
+        std::sort(v.begin(), v.end(), comp);
+        return;
+    }
+
+    ParallelOptions sort_options = options;
+    sort_options.static_chunking = false;
+    sort_options.grain_size = run;
+    T* data = v.begin();
+    parallel_detail::ForChunks(n, sort_options, [data, &comp](size_t, size_t begin, size_t end) {
+        std::sort(data + begin, data + end, comp);
+    });
+
+    // Элементы переезжают в буфер, и первое слияние возвращает их обратно
+    Vector<T> buffer;
+    buffer.AppendUninitialized(n, [data, n](T* out) {
+        std::uninitialized_move_n(data, n, out);
+        return n;
+    });
+    T* src = buffer.begin();
+    T* dst = data;
+    for (; run < n; run *= 2) {
+        const size_t pairs = (n + 2 * run - 1) / (2 * run);
+        ParallelOptions merge_options = options;
+        merge_options.static_chunking = false;
+        merge_options.grain_size = 1;
+        parallel_detail::ForChunks(pairs, merge_options, [&](size_t, size_t first_pair, size_t last_pair) {
+            for (size_t pair = first_pair; pair < last_pair; ++pair) {
+                const size_t begin = pair * 2 * run;
+                const size_t middle = std::min(begin + run, n);
+                const size_t end = std::min(begin + 2 * run, n);
+                std::merge(std::make_move_iterator(src + begin), std::make_move_iterator(src + middle),
+                           std::make_move_iterator(src + middle), std::make_move_iterator(src + end),
+                           dst + begin, comp);
+            }
+        });
+        std::swap(src, dst);
+    }
+    if (src != data) {
+        v.Swap(buffer);
+    }
+}
+
+// Сортирует вектор, выбирая алгоритм по типу и размеру: сеть сортировки для
+// крошечных векторов, поразрядную сортировку для чисел, std::sort для остального
+template <typename T>
+void Sort(Vector<T>& v) {
+    if (v.Size() <= sort_detail::NETWORK_MAX_SIZE) {
+        sort_detail::SortNetwork(v.begin(), v.Size(), std::less<>{});
+    } else if constexpr (std::is_arithmetic_v<T>) {
+        if (v.Size() >= sort_detail::RADIX_MIN_SIZE) {
+            RadixSort(v);
+        } else {
+            std::sort(v.begin(), v.end());
+        }
+    } else {
+        std::sort(v.begin(), v.end());
+    }
+}
+
+template <typename T, typename Compare>
+void Sort(Vector<T>& v, Compare comp) {
+    if (v.Size() <= sort_detail::NETWORK_MAX_SIZE) {
+        sort_detail::SortNetwork(v.begin(), v.Size(), comp);
+    } else {
+        std::sort(v.begin(), v.end(), comp);
+    }
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+
+#if __has_include(<version>)
+#include <version>
+#endif
+#ifdef __cpp_lib_ranges
+#include <ranges>
+#endif
+
+// Невладеющее представление непрерывного участка памяти: указатель и длина.
+// Итераторы — обычные указатели, поэтому в C++20 Span удовлетворяет
+// std::ranges::contiguous_range и передаётся в алгоритмы std::ranges
+// и в std::span без копирования
+template <typename T>
+class Span {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    using element_type = T;
+    using value_type = std::remove_cv_t<T>;
+    using iterator = T*;
+
+    constexpr Span() noexcept = default;
+
+    constexpr Span(T* data, size_t size) noexcept
+            : data_(data)
+            , size_(size) {
+    }
+
+    // Представление изменяемых элементов приводится к представлению константных
+    template <typename U, typename = std::enable_if_t<std::is_same_v<const U, T>>>
+    constexpr Span(const Span<U>& other) noexcept
+            : data_(other.data())
+            , size_(other.size()) {
+    }
+
+    constexpr T& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return data_[index];
+    }
+
+    constexpr T* Data() const noexcept {
+        return data_;
+    }
+
+    constexpr size_t Size() const noexcept {
+        return size_;
+    }
+
+    constexpr bool Empty() const noexcept {
+        return size_ == 0;
+    }
+
+    // Имена в стиле стандартной библиотеки нужны std::ranges и std::span
+    constexpr T* data() const noexcept {
+        return data_;
+    }
+
+    constexpr size_t size() const noexcept {
+        return size_;
+    }
+
+    constexpr bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    constexpr iterator begin() const noexcept {
+        return data_;
+    }
+
+    constexpr iterator end() const noexcept {
+        return data_ + size_;
+    }
+
+    // count элементов начиная с offset; npos — до конца
+    constexpr Span Subspan(size_t offset, size_t count = npos) const noexcept {
+        assert(offset <= size_);
+        if (count == npos) {
+            count = size_ - offset;
+        }
+        assert(count <= size_ - offset);
+        return Span(data_ + offset, count);
+    }
+
+    constexpr Span First(size_t count) const noexcept {
+        return Subspan(0, count);
+    }
+
+    constexpr Span Last(size_t count) const noexcept {
+        assert(count <= size_);
+        return Subspan(size_ - count, count);
+    }
+
+private:
+    T* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+#ifdef __cpp_lib_ranges
+template <typename T>
+inline constexpr bool std::ranges::enable_borrowed_range<Span<T>> = true;
+
+template <typename T>
+inline constexpr bool std::ranges::enable_view<Span<T>> = true;
+#endif
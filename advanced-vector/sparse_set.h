@@ -0,0 +1,169 @@
+#pragma once
+
+#include "vector.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+
+// Разреженное множество: значения и ключи лежат плотно в двух Vector,
+// а страничный разреженный индекс отображает ключ в позицию плотной части.
+// Вставка, удаление и поиск выполняются за O(1), обход идёт по плотному массиву.
+template <typename T>
+class SparseSet {
+public:
+    using iterator = typename Vector<T>::iterator;
+    using const_iterator = typename Vector<T>::const_iterator;
+
+    SparseSet() = default;
+
+    // Вставляет значение по ключу. Если ключ уже есть, значение заменяется
+    template <typename... Args>
+    T& Emplace(uint32_t key, Args&&... args) {
+        uint32_t& slot = SlotFor(key);
+        if (slot != NO_INDEX) {
+            dense_[slot] = T(std::forward<Args>(args)...);
+            return dense_[slot];
+        }
+        T& value = dense_.EmplaceBack(std::forward<Args>(args)...);
+        try {
+            keys_.PushBack(key);
+        } catch (...) {
+            dense_.PopBack();
+            throw;
+        }
+        slot = static_cast<uint32_t>(keys_.Size() - 1);
+        return value;
+    }
+
+    template <typename S>
+    T& Insert(uint32_t key, S&& value) {
+        return Emplace(key, std::forward<S>(value));
+    }
+
+    // Удаляет элемент, перенося последний элемент плотной части на его место
+    bool Erase(uint32_t key) {
+        uint32_t* slot = FindSlot(key);
+        if (slot == nullptr) {
+            return false;
+        }
+        const uint32_t index = *slot;
+        const uint32_t last = static_cast<uint32_t>(keys_.Size() - 1);
+        if (index != last) {
+            dense_[index] = std::move(dense_[last]);
+            keys_[index] = keys_[last];
+            *FindSlot(keys_[index]) = index;
+        }
+        *slot = NO_INDEX;
+        dense_.PopBack();
+        keys_.PopBack();
+        return true;
+    }
+
+    bool Contains(uint32_t key) const noexcept {
+        return const_cast<SparseSet&>(*this).FindSlot(key) != nullptr;
+    }
+
+    T* Find(uint32_t key) noexcept {
+        uint32_t* slot = FindSlot(key);
+        return slot != nullptr ? &dense_[*slot] : nullptr;
+    }
+
+    const T* Find(uint32_t key) const noexcept {
+        return const_cast<SparseSet&>(*this).Find(key);
+    }
+
+    T& operator[](uint32_t key) noexcept {
+        T* value = Find(key);
+        assert(value != nullptr);
+        return *value;
+    }
+
+    const T& operator[](uint32_t key) const noexcept {
+        return const_cast<SparseSet&>(*this)[key];
+    }
+
+    void Clear() noexcept {
+        for (size_t i = 0; i < keys_.Size(); ++i) {
+            *FindSlot(keys_[i]) = NO_INDEX;
+        }
+        dense_.Clear();
+        keys_.Clear();
+    }
+
+    size_t Size() const noexcept {
+        return dense_.Size();
+    }
+
+    bool Empty() const noexcept {
+        return dense_.Size() == 0;
+    }
+
+    // Ключи в том же порядке, что и значения плотной части
+    const Vector<uint32_t>& Keys() const noexcept {
+        return keys_;
+    }
+
+    const Vector<T>& Values() const noexcept {
+        return dense_;
+    }
+
+    iterator begin() noexcept {
+        return dense_.begin();
+    }
+    iterator end() noexcept {
+        return dense_.end();
+    }
+    const_iterator begin() const noexcept {
+        return dense_.begin();
+    }
+    const_iterator end() const noexcept {
+        return dense_.end();
+    }
+
+private:
+    static constexpr uint32_t NO_INDEX = std::numeric_limits<uint32_t>::max();
+    static constexpr uint32_t PAGE_BITS = 12;
+    static constexpr uint32_t PAGE_SIZE = uint32_t{1} << PAGE_BITS;
+
+    uint32_t* FindSlot(uint32_t key) noexcept {
+        const size_t page = key >> PAGE_BITS;
+        if (page >= sparse_.Size() || !sparse_[page]) {
+            return nullptr;
+        }
+        uint32_t* slot = &sparse_[page][key & (PAGE_SIZE - 1)];
+        return *slot != NO_INDEX ? slot : nullptr;
+    }
+
+    // Возвращает ячейку индекса для ключа, при необходимости выделяя страницу
+    uint32_t& SlotFor(uint32_t key) {
+        const size_t page = key >> PAGE_BITS;
+        if (page >= sparse_.Size()) {
+            sparse_.Resize(page + 1);
+        }
+        if (!sparse_[page]) {
+            sparse_[page] = std::make_unique<uint32_t[]>(PAGE_SIZE);
+            std::fill_n(sparse_[page].get(), PAGE_SIZE, NO_INDEX);
+        }
+        return sparse_[page][key & (PAGE_SIZE - 1)];
+    }
+
+    Vector<T> dense_;
+    Vector<uint32_t> keys_;
+    Vector<std::unique_ptr<uint32_t[]>> sparse_;
+};
+
+// Вызывает f(key, value...) для каждого ключа, присутствующего во всех множествах.
+// Обход ведётся по наименьшему из множеств, остальные только опрашиваются
+template <typename F, typename First, typename... Rest>
+void ForEachIntersection(F&& f, First& first, Rest&... rest) {
+    const Vector<uint32_t>* smallest = &first.Keys();
+    ((smallest = rest.Size() < smallest->Size() ? &rest.Keys() : smallest), ...);
+    for (size_t i = 0; i < smallest->Size(); ++i) {
+        const uint32_t key = (*smallest)[i];
+        if (first.Contains(key) && (rest.Contains(key) && ...)) {
+            f(key, first[key], rest[key]...);
+        }
+    }
+}
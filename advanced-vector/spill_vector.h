@@ -0,0 +1,191 @@
+#pragma once
+
+#include "vector.h"
+#include "file_io.h"
+
+#include <limits>
+#include <optional>
+#include <type_traits>
+
+// Вектор тривиально копируемых элементов, который держит в памяти не более
+// заданного бюджета байт. Данные хранятся блоками фиксированного размера;
+// при превышении бюджета давно не использовавшиеся блоки вытесняются во
+// временный файл и подгружаются обратно при обращении
+template <typename T>
+class SpillVector {
+    static_assert(std::is_trivially_copyable_v<T>, "SpillVector requires a trivially copyable type");
+
+public:
+    static constexpr size_t DEFAULT_CHUNK_BYTES = size_t{1} << 20;
+
+    explicit SpillVector(size_t memory_budget, size_t chunk_bytes = DEFAULT_CHUNK_BYTES)
+            : chunk_size_(std::max<size_t>(chunk_bytes / sizeof(T), 1))
+            , max_resident_(std::max<size_t>(memory_budget / (chunk_size_ * sizeof(T)), 2)) {
+    }
+
+    SpillVector(const SpillVector&) = delete;
+    SpillVector& operator=(const SpillVector&) = delete;
+
+    void PushBack(const T& value) {
+        if (size_ % chunk_size_ == 0) {
+            AddChunk();
+        }
+        T* chunk = Touch(size_ / chunk_size_, true);
+        chunk[size_ % chunk_size_] = value;
+        ++size_;
+    }
+
+    template <typename... Args>
+    void EmplaceBack(Args&&... args) {
+        PushBack(T(std::forward<Args>(args)...));
+    }
+
+    // Возвращает копию элемента. Может подгрузить блок с диска
+    T Get(size_t index) {
+        assert(index < size_);
+        return Touch(index / chunk_size_, false)[index % chunk_size_];
+    }
+
+    void Set(size_t index, const T& value) {
+        assert(index < size_);
+        Touch(index / chunk_size_, true)[index % chunk_size_] = value;
+    }
+
+    // Обходит элементы по порядку, подгружая блоки по одному: f(const T&)
+    template <typename F>
+    void ForEach(F&& f) {
+        for (size_t chunk = 0; chunk < chunks_.Size(); ++chunk) {
+            const T* data = Touch(chunk, false);
+            const size_t count = std::min(chunk_size_, size_ - chunk * chunk_size_);
+            for (size_t i = 0; i < count; ++i) {
+                f(data[i]);
+            }
+        }
+    }
+
+    // Копирует count элементов начиная с first в out
+    void CopyTo(size_t first, size_t count, T* out) {
+        assert(first + count <= size_);
+        while (count != 0) {
+            const size_t offset = first % chunk_size_;
+            const size_t n = std::min(count, chunk_size_ - offset);
+            std::copy_n(Touch(first / chunk_size_, false) + offset, n, out);
+            first += n;
+            out += n;
+            count -= n;
+        }
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t ChunkSize() const noexcept {
+        return chunk_size_;
+    }
+
+    size_t ResidentChunks() const noexcept {
+        return resident_;
+    }
+
+    // Был ли хотя бы один блок вытеснен на диск
+    bool Spilled() const noexcept {
+        return file_.has_value();
+    }
+
+private:
+    static constexpr size_t NONE = std::numeric_limits<size_t>::max();
+
+    struct Chunk {
+        RawMemory<T> data;
+        bool on_disk = false;
+        bool dirty = false;
+        size_t prev = NONE;
+        size_t next = NONE;
+    };
+
+    void AddChunk() {
+        // Место в таблице выделяется до вытеснения, чтобы не потерять буфер
+        if (chunks_.Size() == chunks_.Capacity()) {
+            chunks_.Reserve(std::max<size_t>(chunks_.Size() * 2, 1));
+        }
+        RawMemory<T> data = AcquireBuffer();
+        chunks_.EmplaceBack(Chunk{std::move(data)});
+        LinkFront(chunks_.Size() - 1);
+        ++resident_;
+    }
+
+    // Возвращает буфер для нового резидентного блока, при необходимости вытесняя самый старый
+    RawMemory<T> AcquireBuffer() {
+        if (resident_ < max_resident_) {
+            return RawMemory<T>(chunk_size_);
+        }
+        const size_t victim = lru_tail_;
+        Chunk& chunk = chunks_[victim];
+        if (chunk.dirty || !chunk.on_disk) {
+            io_detail::PWriteAll(Fd(), chunk.data.GetAddress(), chunk_size_ * sizeof(T), Offset(victim));
+            chunk.on_disk = true;
+            chunk.dirty = false;
+        }
+        Unlink(victim);
+        --resident_;
+        return std::move(chunk.data);
+    }
+
+    // Делает блок резидентным и самым свежим; возвращает указатель на его данные
+    T* Touch(size_t index, bool write) {
+        if (chunks_[index].data.GetAddress() == nullptr) {
+            RawMemory<T> data = AcquireBuffer();
+            io_detail::PReadAll(Fd(), data.GetAddress(), chunk_size_ * sizeof(T), Offset(index));
+            chunks_[index].data = std::move(data);
+            LinkFront(index);
+            ++resident_;
+        } else if (lru_head_ != index) {
+            Unlink(index);
+            LinkFront(index);
+        }
+        Chunk& chunk = chunks_[index];
+        chunk.dirty = chunk.dirty || write;
+        return chunk.data.GetAddress();
+    }
+
+    void LinkFront(size_t index) noexcept {
+        Chunk& chunk = chunks_[index];
+        chunk.prev = NONE;
+        chunk.next = lru_head_;
+        if (lru_head_ != NONE) {
+            chunks_[lru_head_].prev = index;
+        } else {
+            lru_tail_ = index;
+        }
+        lru_head_ = index;
+    }
+
+    void Unlink(size_t index) noexcept {
+        Chunk& chunk = chunks_[index];
+        (chunk.prev != NONE ? chunks_[chunk.prev].next : lru_head_) = chunk.next;
+        (chunk.next != NONE ? chunks_[chunk.next].prev : lru_tail_) = chunk.prev;
+        chunk.prev = chunk.next = NONE;
+    }
+
+    off_t Offset(size_t chunk) const noexcept {
+        return static_cast<off_t>(chunk * chunk_size_ * sizeof(T));
+    }
+
+    // Временный файл создаётся при первом вытеснении
+    int Fd() {
+        if (!file_) {
+            file_.emplace();
+        }
+        return file_->Fd();
+    }
+
+    const size_t chunk_size_;
+    const size_t max_resident_;
+    Vector<Chunk> chunks_;
+    size_t size_ = 0;
+    size_t resident_ = 0;
+    size_t lru_head_ = NONE;
+    size_t lru_tail_ = NONE;
+    std::optional<TempFile> file_;
+};
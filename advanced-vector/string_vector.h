@@ -0,0 +1,285 @@
+#pragma once
+
+#include "vector.h"
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <string_view>
+
+// Вектор строк с непрерывным хранением: символы всех строк лежат в одном
+// буфере, а границы строк — в векторе смещений. Элементы возвращаются как
+// std::string_view, которые действительны до следующего изменения вектора
+class StringVector {
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = std::string_view;
+
+        const_iterator() = default;
+
+        std::string_view operator*() const noexcept {
+            return (*owner_)[index_];
+        }
+
+        std::string_view operator[](difference_type n) const noexcept {
+            return (*owner_)[index_ + n];
+        }
+
+        const_iterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+
+        const_iterator operator++(int) noexcept {
+            const_iterator old = *this;
+            ++index_;
+            return old;
+        }
+
+        const_iterator& operator--() noexcept {
+            --index_;
+            return *this;
+        }
+
+        const_iterator operator--(int) noexcept {
+            const_iterator old = *this;
+            --index_;
+            return old;
+        }
+
+        const_iterator& operator+=(difference_type n) noexcept {
+            index_ += n;
+            return *this;
+        }
+
+        const_iterator& operator-=(difference_type n) noexcept {
+            index_ -= n;
+            return *this;
+        }
+
+        friend const_iterator operator+(const_iterator it, difference_type n) noexcept {
+            return it += n;
+        }
+
+        friend const_iterator operator+(difference_type n, const_iterator it) noexcept {
+            return it += n;
+        }
+
+        friend const_iterator operator-(const_iterator it, difference_type n) noexcept {
+            return it -= n;
+        }
+
+        friend difference_type operator-(const const_iterator& lhs, const const_iterator& rhs) noexcept {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const const_iterator& lhs, const const_iterator& rhs) noexcept {
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend bool operator!=(const const_iterator& lhs, const const_iterator& rhs) noexcept {
+            return lhs.index_ != rhs.index_;
+        }
+
+        friend bool operator<(const const_iterator& lhs, const const_iterator& rhs) noexcept {
+            return lhs.index_ < rhs.index_;
+        }
+
+        friend bool operator>(const const_iterator& lhs, const const_iterator& rhs) noexcept {
+            return rhs < lhs;
+        }
+
+        friend bool operator<=(const const_iterator& lhs, const const_iterator& rhs) noexcept {
+            return !(rhs < lhs);
+        }
+
+        friend bool operator>=(const const_iterator& lhs, const const_iterator& rhs) noexcept {
+            return !(lhs < rhs);
+        }
+
+    private:
+        friend class StringVector;
+
+        const_iterator(const StringVector* owner, size_t index) noexcept
+                : owner_(owner)
+                , index_(index) {
+        }
+
+        const StringVector* owner_ = nullptr;
+        size_t index_ = 0;
+    };
+
+    // Резервирует место под count строк суммарной длиной bytes символов
+    void Reserve(size_t count, size_t bytes) {
+        offsets_.Reserve(count + 1);
+        chars_.Reserve(bytes);
+        if (offsets_.Size() == 0) {
+            offsets_.PushBack(0);
+        }
+    }
+
+    void EmplaceBack(std::string_view value) {
+        // Место под смещение выделяется заранее, чтобы не оставить символы без строки
+        if (offsets_.Size() == 0) {
+            offsets_.Reserve(2);
+            offsets_.PushBack(0);
+        } else if (offsets_.Size() == offsets_.Capacity()) {
+            offsets_.Reserve(offsets_.Size() * 2);
+        }
+        AppendChars(value.data(), value.size());
+        offsets_.PushBack(chars_.Size());
+    }
+
+    void PushBack(std::string_view value) {
+        EmplaceBack(value);
+    }
+
+    void PopBack() noexcept {
+        assert(Size() != 0);
+        offsets_.PopBack();
+        chars_.Resize(offsets_[offsets_.Size() - 1]);
+    }
+
+    void Clear() noexcept {
+        chars_.Clear();
+        offsets_.Clear();
+    }
+
+    std::string_view operator[](size_t index) const noexcept {
+        assert(index < Size());
+        return std::string_view(chars_.begin() + offsets_[index], offsets_[index + 1] - offsets_[index]);
+    }
+
+    size_t Size() const noexcept {
+        return offsets_.Size() == 0 ? 0 : offsets_.Size() - 1;
+    }
+
+    bool Empty() const noexcept {
+        return Size() == 0;
+    }
+
+    // Суммарная длина всех строк
+    size_t Bytes() const noexcept {
+        return chars_.Size();
+    }
+
+    // Все символы подряд, без разделителей
+    std::string_view Chars() const noexcept {
+        return std::string_view(chars_.begin(), chars_.Size());
+    }
+
+    // Границы строк: Size() + 1 смещений, либо пусто у пустого вектора
+    const Vector<size_t>& Offsets() const noexcept {
+        return offsets_;
+    }
+
+    const_iterator begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    const_iterator end() const noexcept {
+        return const_iterator(this, Size());
+    }
+
+    // Разбивает buffer на строки по разделителю delimiter.
+    // Символы копируются одним блоком, без разделителей
+    static StringVector Split(std::string_view buffer, char delimiter) {
+        StringVector result;
+        size_t count = 1;
+        for (char c : buffer) {
+            count += c == delimiter ? 1 : 0;
+        }
+        result.Reserve(count, buffer.size() - (count - 1));
+        size_t start = 0;
+        for (;;) {
+            const size_t end = buffer.find(delimiter, start);
+            result.EmplaceBack(buffer.substr(start, end == std::string_view::npos ? end : end - start));
+            if (end == std::string_view::npos) {
+                break;
+            }
+            start = end + 1;
+        }
+        return result;
+    }
+
+    // Дописывает в out сериализованное представление: число строк,
+    // смещения (uint64_t в порядке байт машины) и символы
+    void Serialize(Vector<char>& out) const {
+        const uint64_t count = Size();
+        const size_t total = sizeof(uint64_t) * (count + 2) + chars_.Size();
+        out.AppendUninitialized(total, [this, count](char* dst) {
+            std::memcpy(dst, &count, sizeof(count));
+            dst += sizeof(count);
+            for (uint64_t i = 0; i <= count; ++i) {
+                const uint64_t value = i == 0 ? 0 : offsets_[i];
+                std::memcpy(dst, &value, sizeof(value));
+                dst += sizeof(value);
+            }
+            if (chars_.Size() != 0) {
+                std::memcpy(dst, chars_.begin(), chars_.Size());
+            }
+            return sizeof(uint64_t) * (count + 2) + chars_.Size();
+        });
+    }
+
+    // Восстанавливает вектор из буфера, созданного Serialize.
+    // Бросает std::invalid_argument, если буфер повреждён
+    static StringVector Deserialize(std::string_view buffer) {
+        uint64_t count = 0;
+        if (buffer.size() < sizeof(count)) {
+            throw std::invalid_argument("StringVector: truncated header");
+        }
+        std::memcpy(&count, buffer.data(), sizeof(count));
+        buffer.remove_prefix(sizeof(count));
+        if (count >= buffer.size() / sizeof(uint64_t)) {
+            throw std::invalid_argument("StringVector: truncated offsets");
+        }
+        StringVector result;
+        result.offsets_.Reserve(count + 1);
+        uint64_t previous = 0;
+        for (uint64_t i = 0; i <= count; ++i) {
+            uint64_t offset = 0;
+            std::memcpy(&offset, buffer.data() + i * sizeof(offset), sizeof(offset));
+            if (offset < previous || (i == 0 && offset != 0)) {
+                throw std::invalid_argument("StringVector: offsets are not monotonic");
+            }
+            previous = offset;
+            result.offsets_.PushBack(offset);
+        }
+        buffer.remove_prefix((count + 1) * sizeof(uint64_t));
+        if (buffer.size() != previous) {
+            throw std::invalid_argument("StringVector: character data size mismatch");
+        }
+        result.AppendChars(buffer.data(), buffer.size());
+        return result;
+    }
+
+private:
+    void AppendChars(const char* data, size_t size) {
+        if (size == 0) {
+            return;
+        }
+        // Строка может лежать в самом chars_ (PushBack(sv[0])): AppendUninitialized
+        // освободит старый буфер при росте, поэтому запоминается смещение, а
+        // источник берётся уже из нового буфера
+        const std::less<const char*> less;
+        const bool aliased = !less(data, chars_.begin()) && less(data, chars_.end());
+        const size_t offset = aliased ? static_cast<size_t>(data - chars_.begin()) : 0;
+        chars_.AppendUninitialized(size, [this, data, size, aliased, offset](char* dst) {
+            std::memcpy(dst, aliased ? chars_.begin() + offset : data, size);
+            return size;
+        });
+    }
+
+    Vector<char> chars_;
+    // offsets_[i] — начало i-й строки, последний элемент — общий размер.
+    // У пустого вектора смещений нет совсем, поэтому перемещение не требует выделений
+    Vector<size_t> offsets_;
+};
@@ -1,8 +1,15 @@
 #pragma once
 
+#include "span.h"
+
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
+#include <iterator>
+#include <limits>
 #include <new>
+#include <stdexcept>
+#include <type_traits>
 #include <utility>
 #include <memory>
 
@@ -17,6 +24,13 @@ public:
             , capacity_(capacity) {
     }
 
+    // Принимает во владение буфер на capacity элементов, выделенный Allocate
+    RawMemory(T* buffer, size_t capacity) noexcept
+            : buffer_(buffer)
+            , capacity_(capacity) {
+        assert(buffer != nullptr || capacity == 0);
+    }
+
     ~RawMemory() {
         Deallocate(buffer_);
     }
@@ -72,21 +86,51 @@ public:
         return capacity_;
     }
 
-private:
+    // Отдаёт буфер вызывающему, оставляя RawMemory пустым. Освобождать его
+    // нужно через Deallocate
+    T* Release() noexcept {
+        capacity_ = 0;
+        return std::exchange(buffer_, nullptr);
+    }
+
     // Выделяет сырую память под n элементов и возвращает указатель на неё
+    // Для типов с повышенным выравниванием используется выравнивающий operator new.
+    // Только буферы, полученные отсюда, можно передавать во владение RawMemory и Vector
     static T* Allocate(size_t n) {
-        return n != 0 ? static_cast<T*>(operator new(n * sizeof(T))) : nullptr;
+        if (n == 0) {
+            return nullptr;
+        }
+        if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+            return static_cast<T*>(operator new(n * sizeof(T), std::align_val_t{alignof(T)}));
+        } else {
+            return static_cast<T*>(operator new(n * sizeof(T)));
+        }
     }
 
     // Освобождает сырую память, выделенную ранее по адресу buf при помощи Allocate
     static void Deallocate(T* buf) noexcept {
-        operator delete(buf);
+        if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+            operator delete(buf, std::align_val_t{alignof(T)});
+        } else {
+            operator delete(buf);
+        }
     }
 
+private:
     T* buffer_ = nullptr;
     size_t capacity_ = 0;
 };
 
+namespace vector_detail {
+
+template <typename Range, typename = void>
+inline constexpr bool HAS_SIZE = false;
+
+template <typename Range>
+inline constexpr bool HAS_SIZE<Range, std::void_t<decltype(std::size(std::declval<Range&>()))>> = true;
+
+}  // namespace vector_detail
+
 template <typename T>
 class Vector {
 public:
@@ -100,6 +144,41 @@ public:
         std::uninitialized_value_construct_n(data_.GetAddress(), size);
     }
 
+    // Копирует [first, last) с единственным выделением памяти точно под размер
+    template <typename ForwardIt, typename = std::enable_if_t<std::is_base_of_v<
+            std::forward_iterator_tag, typename std::iterator_traits<ForwardIt>::iterator_category>>>
+    Vector(ForwardIt first, ForwardIt last)
+            : data_(static_cast<size_t>(std::distance(first, last)))
+    {
+        std::uninitialized_copy(first, last, data_.GetAddress());
+        size_ = data_.Capacity();
+    }
+
+    // Вектор из элементов любого диапазона. Если длина известна заранее
+    // (есть size() или прямые итераторы), память выделяется один раз и точно
+    template <typename Range>
+    static Vector FromRange(Range&& range) {
+        using std::begin;
+        using std::end;
+        auto first = begin(range);
+        auto last = end(range);
+        using It = decltype(first);
+        if constexpr (std::is_same_v<It, decltype(last)> && std::is_base_of_v<
+                std::forward_iterator_tag, typename std::iterator_traits<It>::iterator_category>) {
+            return Vector(first, last);
+        } else {
+            Vector result;
+            if constexpr (vector_detail::HAS_SIZE<Range>) {
+                using std::size;
+                result.Reserve(static_cast<size_t>(size(range)));
+            }
+            for (; first != last; ++first) {
+                result.EmplaceBack(*first);
+            }
+            return result;
+        }
+    }
+
     ~Vector() {
         std::destroy_n(data_.GetAddress(), size_);
     }
@@ -206,6 +285,59 @@ public:
         return *(data_.GetAddress() + size_++);
     }
 
+    // Дописывает в конец до max_count элементов, конструируемых функцией fill
+    // прямо в неинициализированной памяти буфера. fill(T* dst) должна вернуть
+    // число сконструированных элементов; при исключении она сама разрушает
+    // созданные ею элементы
+    template <typename F>
+    size_t AppendUninitialized(size_t max_count, F&& fill) {
+        if (max_count > MaxSize() - size_) {
+            throw std::length_error("Vector::AppendUninitialized: size exceeds MaxSize()");
+        }
+        if (size_ + max_count > data_.Capacity()) {
+            Reserve(std::max(size_ + max_count, size_ * 2));
+        }
+        const size_t count = fill(data_.GetAddress() + size_);
+        assert(count <= max_count);
+        size_ += count;
+        return count;
+    }
+
+    // Буфер вектора вместе с владением: первые size элементов живые
+    struct Buffer {
+        T* data = nullptr;
+        size_t size = 0;
+        size_t capacity = 0;
+    };
+
+    // Передаёт буфер вызывающему без копирования и оставляет вектор пустым.
+    // Вызывающий отвечает за разрушение size элементов и освобождение
+    // памяти через RawMemory<T>::Deallocate либо возвращает буфер в Adopt
+    [[nodiscard]] Buffer Release() noexcept {
+        const size_t capacity = data_.Capacity();
+        return Buffer{data_.Release(), std::exchange(size_, 0), capacity};
+    }
+
+    // Создаёт вектор, владеющий буфером data, в котором уже сконструированы
+    // первые size из capacity элементов. Память должна быть выделена
+    // RawMemory<T>::Allocate(capacity): её освободит соответствующий Deallocate
+    static Vector Adopt(T* data, size_t size, size_t capacity) noexcept {
+        assert(size <= capacity);
+        Vector result;
+        result.data_ = RawMemory<T>(data, capacity);
+        result.size_ = size;
+        return result;
+    }
+
+    static Vector Adopt(Buffer buffer) noexcept {
+        return Adopt(buffer.data, buffer.size, buffer.capacity);
+    }
+
+    void Clear() noexcept {
+        std::destroy_n(data_.GetAddress(), size_);
+        size_ = 0;
+    }
+
     void PopBack() noexcept {
         assert(size_ != 0);
         std::destroy_n(data_.GetAddress() + (size_ - 1), 1);
@@ -216,6 +348,11 @@ public:
         return size_;
     }
 
+    // Наибольшее число элементов, размер которых в байтах представим в ptrdiff_t
+    static constexpr size_t MaxSize() noexcept {
+        return static_cast<size_t>(std::numeric_limits<std::ptrdiff_t>::max()) / sizeof(T);
+    }
+
     size_t Capacity() const noexcept {
         return data_.Capacity();
     }
@@ -229,6 +366,41 @@ public:
         return data_[index];
     }
 
+    // Имена в стиле стандартной библиотеки: с ними Vector — sized_range
+    // и contiguous_range для std::ranges и источник для std::span
+    T* data() noexcept {
+        return data_.GetAddress();
+    }
+
+    const T* data() const noexcept {
+        return data_.GetAddress();
+    }
+
+    size_t size() const noexcept {
+        return size_;
+    }
+
+    bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    Span<T> AsSpan() noexcept {
+        return Span<T>(data_.GetAddress(), size_);
+    }
+
+    Span<const T> AsSpan() const noexcept {
+        return Span<const T>(data_.GetAddress(), size_);
+    }
+
+    // Представление count элементов начиная с offset, без копирования
+    Span<T> Slice(size_t offset, size_t count) noexcept {
+        return AsSpan().Subspan(offset, count);
+    }
+
+    Span<const T> Slice(size_t offset, size_t count) const noexcept {
+        return AsSpan().Subspan(offset, count);
+    }
+
     using iterator = T*;
 
     using const_iterator = const T*;
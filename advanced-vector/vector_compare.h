@@ -0,0 +1,379 @@
+#pragma once
+
+#include "vector.h"
+#include "simd.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+
+#ifdef __cpp_impl_three_way_comparison
+#include <compare>
+#endif
+
+// Сравнение и хеширование векторов. Для целых, перечислений и указателей
+// равенство побайтовое и сводится к memcmp, для чисел с плавающей точкой
+// первое расхождение ищется ядром на векторных расширениях с выбором набора
+// инструкций при выполнении (simd.h). Остальные типы сравниваются
+// поэлементно своими операторами
+namespace compare_detail {
+
+// Равные значения совпадают побайтно. Классы сюда не входят: их operator==
+// может учитывать не все байты
+template <typename T>
+inline constexpr bool IS_BITWISE = std::is_scalar_v<T> && std::has_unique_object_representations_v<T>;
+
+// Побайтовый порядок memcmp совпадает с порядком значений
+template <typename T>
+inline constexpr bool IS_BYTE_ORDERED = std::is_integral_v<T> && std::is_unsigned_v<T> && sizeof(T) == 1;
+
+// Типы, которые помещаются в дорожки векторных регистров
+template <typename T>
+inline constexpr bool IS_SIMD = std::is_same_v<T, float> || std::is_same_v<T, double>
+                                || (std::is_integral_v<T> && !std::is_same_v<T, bool> && sizeof(T) <= 8);
+
+template <typename T>
+inline constexpr bool IS_FAST_ORDER = IS_BYTE_ORDERED<T> || IS_SIMD<T>;
+
+// Целые в регистре сравниваются как беззнаковые той же ширины: для
+// равенства это то же самое, а символьные типы не все годятся в дорожки
+template <typename T, typename = void>
+struct LaneType {
+    using type = T;
+};
+
+template <typename T>
+struct LaneType<T, std::enable_if_t<std::is_integral_v<T>>> {
+    using type = std::conditional_t<
+            sizeof(T) == 1, uint8_t,
+            std::conditional_t<sizeof(T) == 2, uint16_t, std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>>;
+};
+
+template <typename M>
+ADVANCED_VECTOR_INLINE bool AnyLane(const M& mask) noexcept {
+    uint64_t words[sizeof(M) / sizeof(uint64_t)];
+    std::memcpy(words, &mask, sizeof(M));
+    uint64_t any = 0;
+    for (const uint64_t word : words) {
+        any |= word;
+    }
+    return any != 0;
+}
+
+// Индекс первой позиции, где !(a[i] == b[i]), или n. NaN не равен ничему,
+// -0.0 равен 0.0, как и при поэлементном сравнении
+template <typename T, size_t BYTES>
+ADVANCED_VECTOR_INLINE size_t MismatchKernel(const T* a, const T* b, size_t n) noexcept {
+    using V = simd_detail::Simd<typename LaneType<T>::type, BYTES>;
+    constexpr size_t LANES = BYTES / sizeof(T);
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        V va;
+        V vb;
+        simd_detail::Load(va, a + i);
+        simd_detail::Load(vb, b + i);
+        const auto mask = va != vb;
+        if (AnyLane(mask)) {
+            break;
+        }
+    }
+    while (i < n && a[i] == b[i]) {
+        ++i;
+    }
+    return i;
+}
+
+template <typename T>
+struct BaselineCompare {
+    static size_t Mismatch(const T* a, const T* b, size_t n) noexcept {
+        return MismatchKernel<T, 16>(a, b, n);
+    }
+};
+
+#if ADVANCED_VECTOR_X86_DISPATCH
+
+template <typename T>
+struct Avx2Compare {
+    ADVANCED_VECTOR_TARGET("avx2") static size_t Mismatch(const T* a, const T* b, size_t n) noexcept {
+        return MismatchKernel<T, 32>(a, b, n);
+    }
+};
+
+template <typename T>
+struct Avx512Compare {
+    ADVANCED_VECTOR_TARGET("avx512f") static size_t Mismatch(const T* a, const T* b, size_t n) noexcept {
+        return MismatchKernel<T, 64>(a, b, n);
+    }
+};
+
+#endif  // ADVANCED_VECTOR_X86_DISPATCH
+
+template <typename T>
+size_t Mismatch(const T* a, const T* b, size_t n) noexcept {
+#if ADVANCED_VECTOR_X86_DISPATCH
+    const SimdLevel level = DetectSimdLevel();
+    if (level == SimdLevel::AVX512) {
+        return Avx512Compare<T>::Mismatch(a, b, n);
+    }
+    if (level == SimdLevel::AVX2) {
+        return Avx2Compare<T>::Mismatch(a, b, n);
+    }
+#endif
+    return BaselineCompare<T>::Mismatch(a, b, n);
+}
+
+template <typename T>
+bool Equal(const T* a, const T* b, size_t n) {
+    if constexpr (IS_BITWISE<T>) {
+        return n == 0 || std::memcmp(a, b, n * sizeof(T)) == 0;
+    } else if constexpr (IS_SIMD<T>) {
+        return Mismatch(a, b, n) == n;
+    } else {
+        return std::equal(a, a + n, b);
+    }
+}
+
+enum class Order {
+    LESS,
+    EQUAL,
+    GREATER,
+    // В первой несовпадающей позиции NaN
+    UNORDERED,
+};
+
+// Лексикографическое сравнение для типов с IS_FAST_ORDER. Как и std::vector
+// в C++20, останавливается на первой позиции, где элементы не равны
+template <typename T>
+Order CompareFast(const T* a, size_t n, const T* b, size_t m) noexcept {
+    const size_t common = std::min(n, m);
+    if constexpr (IS_BYTE_ORDERED<T>) {
+        const int result = common == 0 ? 0 : std::memcmp(a, b, common);
+        if (result != 0) {
+            return result < 0 ? Order::LESS : Order::GREATER;
+        }
+    } else {
+        const size_t i = Mismatch(a, b, common);
+        if (i < common) {
+            if (a[i] < b[i]) {
+                return Order::LESS;
+            }
+            return b[i] < a[i] ? Order::GREATER : Order::UNORDERED;
+        }
+    }
+    if (n == m) {
+        return Order::EQUAL;
+    }
+    return n < m ? Order::LESS : Order::GREATER;
+}
+
+template <typename T>
+bool Less(const Vector<T>& lhs, const Vector<T>& rhs) {
+    if constexpr (IS_FAST_ORDER<T>) {
+        return CompareFast(lhs.begin(), lhs.Size(), rhs.begin(), rhs.Size()) == Order::LESS;
+    } else {
+        return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+}
+
+// Хеш в духе wyhash: 128-битное произведение с folding по 48 байт за шаг
+inline constexpr uint64_t SECRET[4] = {0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL, 0x8ebc6af09c88c6e3ULL,
+                                       0x589965cc75374cc3ULL};
+
+#ifdef __SIZEOF_INT128__
+// __extension__ убирает предупреждение -pedantic о нестандартном типе
+__extension__ typedef unsigned __int128 Uint128;
+#endif
+
+// Полное произведение: в a младшие 64 бита, в b старшие
+inline void Multiply(uint64_t& a, uint64_t& b) noexcept {
+#ifdef __SIZEOF_INT128__
+    const Uint128 product = static_cast<Uint128>(a) * b;
+    a = static_cast<uint64_t>(product);
+    b = static_cast<uint64_t>(product >> 64);
+#else
+    const uint64_t a_hi = a >> 32;
+    const uint64_t a_lo = static_cast<uint32_t>(a);
+    const uint64_t b_hi = b >> 32;
+    const uint64_t b_lo = static_cast<uint32_t>(b);
+    const uint64_t lo_lo = a_lo * b_lo;
+    const uint64_t hi_lo = a_hi * b_lo;
+    const uint64_t lo_hi = a_lo * b_hi;
+    const uint64_t cross = (lo_lo >> 32) + static_cast<uint32_t>(hi_lo) + lo_hi;
+    a = (cross << 32) | static_cast<uint32_t>(lo_lo);
+    b = a_hi * b_hi + (hi_lo >> 32) + (cross >> 32);
+#endif
+}
+
+inline uint64_t Mix(uint64_t a, uint64_t b) noexcept {
+    Multiply(a, b);
+    return a ^ b;
+}
+
+inline uint64_t Read64(const unsigned char* p) noexcept {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint64_t Read32(const unsigned char* p) noexcept {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed) noexcept {
+    const auto* p = static_cast<const unsigned char*>(data);
+    seed ^= Mix(seed ^ SECRET[0], SECRET[1]);
+    uint64_t a = 0;
+    uint64_t b = 0;
+    if (size <= 16) {
+        if (size >= 4) {
+            const size_t shift = (size >> 3) << 2;
+            a = (Read32(p) << 32) | Read32(p + shift);
+            b = (Read32(p + size - 4) << 32) | Read32(p + size - 4 - shift);
+        } else if (size > 0) {
+            a = (uint64_t{p[0]} << 16) | (uint64_t{p[size >> 1]} << 8) | p[size - 1];
+        }
+    } else {
+        size_t rest = size;
+        if (rest > 48) {
+            // Три независимые цепочки умножений идут параллельно в конвейере
+            uint64_t seed1 = seed;
+            uint64_t seed2 = seed;
+            do {
+                seed = Mix(Read64(p) ^ SECRET[1], Read64(p + 8) ^ seed);
+                seed1 = Mix(Read64(p + 16) ^ SECRET[2], Read64(p + 24) ^ seed1);
+                seed2 = Mix(Read64(p + 32) ^ SECRET[3], Read64(p + 40) ^ seed2);
+                p += 48;
+                rest -= 48;
+            } while (rest > 48);
+            seed ^= seed1 ^ seed2;
+        }
+        while (rest > 16) {
+            seed = Mix(Read64(p) ^ SECRET[1], Read64(p + 8) ^ seed);
+            p += 16;
+            rest -= 16;
+        }
+        a = Read64(p + rest - 16);
+        b = Read64(p + rest - 8);
+    }
+    a ^= SECRET[1];
+    b ^= seed;
+    Multiply(a, b);
+    return Mix(a ^ SECRET[0] ^ size, b ^ SECRET[1]);
+}
+
+}  // namespace compare_detail
+
+// Хеш содержимого вектора. Векторы из IS_BITWISE-элементов хешируются как
+// один блок байтов, остальные — сверткой std::hash элементов
+template <typename T>
+uint64_t HashVector(const Vector<T>& v, uint64_t seed = 0) {
+    using namespace compare_detail;
+    if constexpr (IS_BITWISE<T>) {
+        return HashBytes(v.begin(), v.Size() * sizeof(T), seed);
+    } else {
+        uint64_t state = seed ^ Mix(seed ^ SECRET[0], SECRET[1]);
+        for (const T& value : v) {
+            state = Mix(state ^ SECRET[1], static_cast<uint64_t>(std::hash<T>{}(value)) ^ SECRET[2]);
+        }
+        return Mix(state ^ SECRET[0] ^ v.Size(), SECRET[3]);
+    }
+}
+
+template <typename T>
+struct std::hash<Vector<T>> {
+    size_t operator()(const Vector<T>& v) const {
+        return static_cast<size_t>(HashVector(v));
+    }
+};
+
+template <typename T>
+bool operator==(const Vector<T>& lhs, const Vector<T>& rhs) {
+    return lhs.Size() == rhs.Size() && compare_detail::Equal(lhs.begin(), rhs.begin(), lhs.Size());
+}
+
+#ifdef __cpp_impl_three_way_comparison
+
+namespace compare_detail {
+
+template <typename R>
+R ToOrdering(Order order) noexcept {
+    switch (order) {
+        case Order::LESS:
+            return R::less;
+        case Order::GREATER:
+            return R::greater;
+        case Order::EQUAL:
+            return R::equivalent;
+        default:
+            if constexpr (std::is_same_v<R, std::partial_ordering>) {
+                return R::unordered;
+            } else {
+                assert(false);
+                return R::equivalent;
+            }
+    }
+}
+
+// Как synth-three-way у std::vector: для типов только с operator< порядок слабый
+struct SynthThreeWay {
+    template <typename T>
+    auto operator()(const T& lhs, const T& rhs) const {
+        if constexpr (std::three_way_comparable<T>) {
+            return lhs <=> rhs;
+        } else {
+            if (lhs < rhs) {
+                return std::weak_ordering::less;
+            }
+            return rhs < lhs ? std::weak_ordering::greater : std::weak_ordering::equivalent;
+        }
+    }
+};
+
+}  // namespace compare_detail
+
+// Лексикографический порядок; операторы <, <= и т.д. компилятор выводит из него
+template <typename T>
+auto operator<=>(const Vector<T>& lhs, const Vector<T>& rhs) {
+    using namespace compare_detail;
+    if constexpr (IS_FAST_ORDER<T>) {
+        using Result = std::compare_three_way_result_t<T>;
+        return ToOrdering<Result>(CompareFast(lhs.begin(), lhs.Size(), rhs.begin(), rhs.Size()));
+    } else {
+        return std::lexicographical_compare_three_way(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                                                      SynthThreeWay{});
+    }
+}
+
+#else
+
+template <typename T>
+bool operator!=(const Vector<T>& lhs, const Vector<T>& rhs) {
+    return !(lhs == rhs);
+}
+
+// Лексикографический порядок
+template <typename T>
+bool operator<(const Vector<T>& lhs, const Vector<T>& rhs) {
+    return compare_detail::Less(lhs, rhs);
+}
+
+template <typename T>
+bool operator>(const Vector<T>& lhs, const Vector<T>& rhs) {
+    return compare_detail::Less(rhs, lhs);
+}
+
+template <typename T>
+bool operator<=(const Vector<T>& lhs, const Vector<T>& rhs) {
+    return !compare_detail::Less(rhs, lhs);
+}
+
+template <typename T>
+bool operator>=(const Vector<T>& lhs, const Vector<T>& rhs) {
+    return !compare_detail::Less(lhs, rhs);
+}
+
+#endif  // __cpp_impl_three_way_comparison
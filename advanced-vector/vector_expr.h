@@ -0,0 +1,366 @@
+#pragma once
+
+#include "vector.h"
+
+#include <cmath>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+// Ленивые поэлементные выражения над числовыми векторами. Операторы и
+// функции ниже не вычисляют ничего сами, а строят дерево выражения;
+// Assign и Evaluate проходят его одним циклом без промежуточных векторов.
+// Сравнения оформлены функциями (Lt, Eq, ...), чтобы операторы == и <
+// у Vector оставались сравнением векторов целиком
+namespace expr_detail {
+
+// Лист-вектор: хранит указатель на данные, чтобы цикл работал с сырой памятью
+template <typename T>
+class Terminal {
+public:
+    using value_type = T;
+
+    explicit Terminal(const Vector<T>& v) noexcept
+            : data_(v.begin())
+            , size_(v.Size()) {
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    T operator[](size_t index) const noexcept {
+        return data_[index];
+    }
+
+private:
+    const T* data_;
+    size_t size_;
+};
+
+// Лист-скаляр, одинаковый для всех позиций
+template <typename T>
+class Scalar {
+public:
+    using value_type = T;
+
+    explicit Scalar(T value) noexcept
+            : value_(value) {
+    }
+
+    T operator[](size_t) const noexcept {
+        return value_;
+    }
+
+private:
+    T value_;
+};
+
+template <typename Op, typename E>
+class Unary {
+public:
+    using value_type = decltype(std::declval<Op>()(std::declval<typename E::value_type>()));
+
+    explicit Unary(E operand) noexcept
+            : operand_(operand) {
+    }
+
+    size_t Size() const noexcept {
+        return operand_.Size();
+    }
+
+    value_type operator[](size_t index) const {
+        return Op{}(operand_[index]);
+    }
+
+private:
+    E operand_;
+};
+
+template <typename E>
+inline constexpr bool IS_SCALAR = false;
+
+template <typename T>
+inline constexpr bool IS_SCALAR<Scalar<T>> = true;
+
+// Размер узла с несколькими операндами: берётся у первого нескалярного
+template <typename E, typename... Rest>
+size_t CommonSize(const E& first, const Rest&... rest) noexcept {
+    if constexpr (IS_SCALAR<E>) {
+        return CommonSize(rest...);
+    } else {
+        return first.Size();
+    }
+}
+
+// Скаляр подходит к любой длине, остальные операнды должны совпадать с ней
+template <typename E>
+bool FitsSize(const E& operand, size_t size) noexcept {
+    if constexpr (IS_SCALAR<E>) {
+        return true;
+    } else {
+        return operand.Size() == size;
+    }
+}
+
+template <typename Op, typename L, typename R>
+class Binary {
+public:
+    using value_type = decltype(std::declval<Op>()(std::declval<typename L::value_type>(),
+                                                   std::declval<typename R::value_type>()));
+
+    Binary(L lhs, R rhs) noexcept
+            : lhs_(lhs)
+            , rhs_(rhs) {
+        if constexpr (!IS_SCALAR<L> && !IS_SCALAR<R>) {
+            assert(lhs_.Size() == rhs_.Size());
+        }
+    }
+
+    size_t Size() const noexcept {
+        return CommonSize(lhs_, rhs_);
+    }
+
+    value_type operator[](size_t index) const {
+        return Op{}(lhs_[index], rhs_[index]);
+    }
+
+private:
+    L lhs_;
+    R rhs_;
+};
+
+// Выбор по условию без ветвлений: оба варианта вычисляются для каждой позиции
+template <typename C, typename A, typename B>
+class Select {
+public:
+    using value_type = std::common_type_t<typename A::value_type, typename B::value_type>;
+
+    Select(C condition, A if_true, B if_false) noexcept
+            : condition_(condition)
+            , if_true_(if_true)
+            , if_false_(if_false) {
+        assert(FitsSize(condition_, Size()) && FitsSize(if_true_, Size()) && FitsSize(if_false_, Size()));
+    }
+
+    size_t Size() const noexcept {
+        return CommonSize(condition_, if_true_, if_false_);
+    }
+
+    value_type operator[](size_t index) const {
+        const value_type a = if_true_[index];
+        const value_type b = if_false_[index];
+        return condition_[index] ? a : b;
+    }
+
+private:
+    C condition_;
+    A if_true_;
+    B if_false_;
+};
+
+template <typename E>
+struct IsNode : std::false_type {};
+
+template <typename T>
+struct IsNode<Terminal<T>> : std::true_type {};
+
+template <typename Op, typename E>
+struct IsNode<Unary<Op, E>> : std::true_type {};
+
+template <typename Op, typename L, typename R>
+struct IsNode<Binary<Op, L, R>> : std::true_type {};
+
+template <typename C, typename A, typename B>
+struct IsNode<Select<C, A, B>> : std::true_type {};
+
+template <typename T>
+struct IsNumericVector : std::false_type {};
+
+template <typename T>
+struct IsNumericVector<Vector<T>> : std::is_arithmetic<T> {};
+
+// Вектор или узел выражения — то, что задаёт длину результата
+template <typename T>
+inline constexpr bool IS_ARRAY = IsNode<std::decay_t<T>>::value || IsNumericVector<std::decay_t<T>>::value;
+
+template <typename T>
+inline constexpr bool IS_OPERAND = IS_ARRAY<T> || std::is_arithmetic_v<std::decay_t<T>>;
+
+// Хотя бы один операнд должен быть вектором или выражением, иначе
+// операторы перехватывали бы арифметику над обычными числами
+template <typename... Ts>
+using EnableIfExpr = std::enable_if_t<(IS_OPERAND<Ts> && ...) && (IS_ARRAY<Ts> || ...)>;
+
+template <typename T>
+auto Wrap(const T& value) noexcept {
+    if constexpr (IsNumericVector<T>::value) {
+        return Terminal<std::decay_t<decltype(*value.begin())>>(value);
+    } else if constexpr (std::is_arithmetic_v<T>) {
+        return Scalar<T>(value);
+    } else {
+        return value;
+    }
+}
+
+template <typename T>
+using Wrapped = decltype(Wrap(std::declval<const std::decay_t<T>&>()));
+
+template <typename Op, typename L, typename R>
+auto MakeBinary(const L& lhs, const R& rhs) noexcept {
+    return Binary<Op, Wrapped<L>, Wrapped<R>>(Wrap(lhs), Wrap(rhs));
+}
+
+struct SqrtOp {
+    template <typename T>
+    auto operator()(T value) const {
+        return std::sqrt(value);
+    }
+};
+
+struct AbsOp {
+    template <typename T>
+    T operator()(T value) const {
+        if constexpr (std::is_unsigned_v<T>) {
+            return value;
+        } else {
+            return value < 0 ? -value : value;
+        }
+    }
+};
+
+struct MinOp {
+    template <typename L, typename R>
+    auto operator()(L lhs, R rhs) const {
+        using Common = std::common_type_t<L, R>;
+        return rhs < lhs ? static_cast<Common>(rhs) : static_cast<Common>(lhs);
+    }
+};
+
+struct MaxOp {
+    template <typename L, typename R>
+    auto operator()(L lhs, R rhs) const {
+        using Common = std::common_type_t<L, R>;
+        return lhs < rhs ? static_cast<Common>(rhs) : static_cast<Common>(lhs);
+    }
+};
+
+}  // namespace expr_detail
+
+// Vector<T>, узел выражения и число: a + b * c, 2.0 * x, -x
+template <typename L, typename R, typename = expr_detail::EnableIfExpr<L, R>>
+auto operator+(const L& lhs, const R& rhs) noexcept {
+    return expr_detail::MakeBinary<std::plus<>>(lhs, rhs);
+}
+
+template <typename L, typename R, typename = expr_detail::EnableIfExpr<L, R>>
+auto operator-(const L& lhs, const R& rhs) noexcept {
+    return expr_detail::MakeBinary<std::minus<>>(lhs, rhs);
+}
+
+template <typename L, typename R, typename = expr_detail::EnableIfExpr<L, R>>
+auto operator*(const L& lhs, const R& rhs) noexcept {
+    return expr_detail::MakeBinary<std::multiplies<>>(lhs, rhs);
+}
+
+template <typename L, typename R, typename = expr_detail::EnableIfExpr<L, R>>
+auto operator/(const L& lhs, const R& rhs) noexcept {
+    return expr_detail::MakeBinary<std::divides<>>(lhs, rhs);
+}
+
+template <typename E, typename = expr_detail::EnableIfExpr<E>>
+auto operator-(const E& operand) noexcept {
+    using Wrapped = expr_detail::Wrapped<E>;
+    return expr_detail::Unary<std::negate<>, Wrapped>(expr_detail::Wrap(operand));
+}
+
+template <typename E, typename = expr_detail::EnableIfExpr<E>>
+auto Sqrt(const E& operand) noexcept {
+    using Wrapped = expr_detail::Wrapped<E>;
+    return expr_detail::Unary<expr_detail::SqrtOp, Wrapped>(expr_detail::Wrap(operand));
+}
+
+template <typename E, typename = expr_detail::EnableIfExpr<E>>
+auto Abs(const E& operand) noexcept {
+    using Wrapped = expr_detail::Wrapped<E>;
+    return expr_detail::Unary<expr_detail::AbsOp, Wrapped>(expr_detail::Wrap(operand));
+}
+
+template <typename L, typename R, typename = expr_detail::EnableIfExpr<L, R>>
+auto Min(const L& lhs, const R& rhs) noexcept {
+    return expr_detail::MakeBinary<expr_detail::MinOp>(lhs, rhs);
+}
+
+template <typename L, typename R, typename = expr_detail::EnableIfExpr<L, R>>
+auto Max(const L& lhs, const R& rhs) noexcept {
+    return expr_detail::MakeBinary<expr_detail::MaxOp>(lhs, rhs);
+}
+
+// Поэлементные сравнения; результат — выражение со значениями bool
+template <typename L, typename R, typename = expr_detail::EnableIfExpr<L, R>>
+auto Lt(const L& lhs, const R& rhs) noexcept {
+    return expr_detail::MakeBinary<std::less<>>(lhs, rhs);
+}
+
+template <typename L, typename R, typename = expr_detail::EnableIfExpr<L, R>>
+auto Le(const L& lhs, const R& rhs) noexcept {
+    return expr_detail::MakeBinary<std::less_equal<>>(lhs, rhs);
+}
+
+template <typename L, typename R, typename = expr_detail::EnableIfExpr<L, R>>
+auto Gt(const L& lhs, const R& rhs) noexcept {
+    return expr_detail::MakeBinary<std::greater<>>(lhs, rhs);
+}
+
+template <typename L, typename R, typename = expr_detail::EnableIfExpr<L, R>>
+auto Ge(const L& lhs, const R& rhs) noexcept {
+    return expr_detail::MakeBinary<std::greater_equal<>>(lhs, rhs);
+}
+
+template <typename L, typename R, typename = expr_detail::EnableIfExpr<L, R>>
+auto Eq(const L& lhs, const R& rhs) noexcept {
+    return expr_detail::MakeBinary<std::equal_to<>>(lhs, rhs);
+}
+
+template <typename L, typename R, typename = expr_detail::EnableIfExpr<L, R>>
+auto Ne(const L& lhs, const R& rhs) noexcept {
+    return expr_detail::MakeBinary<std::not_equal_to<>>(lhs, rhs);
+}
+
+// condition ? if_true : if_false поэлементно
+template <typename C, typename A, typename B, typename = expr_detail::EnableIfExpr<C, A, B>>
+auto Where(const C& condition, const A& if_true, const B& if_false) noexcept {
+    using namespace expr_detail;
+    return Select<Wrapped<C>, Wrapped<A>, Wrapped<B>>(Wrap(condition), Wrap(if_true), Wrap(if_false));
+}
+
+// Вычисляет выражение одним циклом в dst. Если размер dst уже совпадает,
+// запись идёт на месте, поэтому dst может быть операндом: Assign(x, x * 2.0).
+// Иначе память dst переиспользуется без заполнения нулями
+template <typename T, typename E, typename = std::enable_if_t<expr_detail::IsNode<E>::value>>
+void Assign(Vector<T>& dst, const E& expr) {
+    const size_t size = expr.Size();
+    if (dst.Size() == size) {
+        T* out = dst.begin();
+        for (size_t i = 0; i < size; ++i) {
+            out[i] = static_cast<T>(expr[i]);
+        }
+        return;
+    }
+    dst.Clear();
+    dst.Reserve(size);
+    dst.AppendUninitialized(size, [&expr, size](T* out) {
+        for (size_t i = 0; i < size; ++i) {
+            out[i] = static_cast<T>(expr[i]);
+        }
+        return size;
+    });
+}
+
+// Вычисляет выражение в новый вектор его типа значений
+template <typename E, typename = std::enable_if_t<expr_detail::IsNode<E>::value>>
+Vector<typename E::value_type> Evaluate(const E& expr) {
+    Vector<typename E::value_type> result;
+    Assign(result, expr);
+    return result;
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "vector.h"
+#include "file_io.h"
+#include "sharded_vector.h"
+#include "string_vector.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+
+#include <sys/stat.h>
+
+namespace io_detail {
+
+inline constexpr size_t PROBE_BYTES = 4096;
+
+// Шаги чтения из каналов и сокетов, размер которых заранее неизвестен:
+// буфер растёт по мере прихода данных, а не сразу на весь запрошенный объём
+inline constexpr size_t STREAM_STEP_BYTES = size_t{64} << 10;
+inline constexpr size_t MAX_STREAM_STEP_BYTES = size_t{16} << 20;
+
+// Сколько байт осталось прочитать от текущей позиции, если fd — обычный файл
+inline std::optional<size_t> RegularFileRemaining(int fd) noexcept {
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        return std::nullopt;
+    }
+    const off_t position = ::lseek(fd, 0, SEEK_CUR);
+    if (position < 0) {
+        return std::nullopt;
+    }
+    return position >= st.st_size ? 0 : static_cast<size_t>(st.st_size - position);
+}
+
+// Сколько байт осталось прочитать из обычного файла от текущей позиции; 0, если неизвестно
+inline size_t RemainingBytesHint(int fd) noexcept {
+    return RegularFileRemaining(fd).value_or(0);
+}
+
+template <typename T>
+size_t CheckWholeElements(size_t bytes) {
+    if (bytes % sizeof(T) != 0) {
+        throw std::invalid_argument("Input size is not a multiple of the element size");
+    }
+    return bytes / sizeof(T);
+}
+
+}  // namespace io_detail
+
+// Читает из fd до max_bytes байт (с точностью до целого элемента) прямо в
+// неинициализированный хвост буфера v, без промежуточного буфера и обнуления.
+// max_bytes — только предел: для обычного файла ёмкость резервируется по
+// остатку из fstat, для каналов и сокетов растёт шагами от STREAM_STEP_BYTES.
+// Неполные чтения повторяются до заполнения или конца файла. Возвращает число
+// добавленных элементов; бросает std::invalid_argument, если файл закончился
+// посреди элемента, и std::system_error при ошибке чтения
+template <typename T>
+size_t ReadAppend(int fd, Vector<T>& v, size_t max_bytes) {
+    static_assert(std::is_trivially_copyable_v<T>, "ReadAppend requires a trivially copyable type");
+    size_t remaining = max_bytes / sizeof(T);
+    size_t stream_step = std::max<size_t>(io_detail::STREAM_STEP_BYTES / sizeof(T), 1);
+    const size_t max_stream_step = std::max<size_t>(io_detail::MAX_STREAM_STEP_BYTES / sizeof(T), 1);
+    size_t appended = 0;
+    while (remaining != 0) {
+        size_t step = 0;
+        if (const std::optional<size_t> bytes = io_detail::RegularFileRemaining(fd)) {
+            // Неполный последний элемент тоже запрашивается, чтобы ReadFull его заметил
+            step = std::min(remaining, *bytes / sizeof(T) + (*bytes % sizeof(T) != 0));
+            if (step == 0) {
+                break;
+            }
+            v.Reserve(v.Size() + step);
+        } else {
+            step = std::min(remaining, stream_step);
+            stream_step = std::min(stream_step * 2, max_stream_step);
+        }
+        const size_t count = v.AppendUninitialized(step, [fd, step](T* dst) {
+            return io_detail::CheckWholeElements<T>(io_detail::ReadFull(fd, dst, step * sizeof(T)));
+        });
+        appended += count;
+        remaining -= count;
+        if (count < step) {
+            break;
+        }
+    }
+    return appended;
+}
+
+// Дочитывает fd до конца, дописывая данные в v. Для обычных файлов ёмкость
+// резервируется один раз по размеру из fstat; конец файла проверяется чтением
+// в небольшой буфер на стеке, чтобы точное резервирование не удваивалось зря
+template <typename T>
+size_t ReadAll(int fd, Vector<T>& v) {
+    static_assert(std::is_trivially_copyable_v<T>, "ReadAll requires a trivially copyable type");
+    const size_t initial_size = v.Size();
+    if (const size_t hint = io_detail::RemainingBytesHint(fd); hint != 0) {
+        v.Reserve(v.Size() + hint / sizeof(T));
+    }
+    constexpr size_t PROBE_COUNT = std::max<size_t>(io_detail::PROBE_BYTES / sizeof(T), 1);
+    for (;;) {
+        const size_t spare = v.Capacity() - v.Size();
+        if (spare != 0) {
+            if (ReadAppend(fd, v, spare * sizeof(T)) < spare) {
+                break;
+            }
+            continue;
+        }
+        alignas(T) unsigned char probe[PROBE_COUNT * sizeof(T)];
+        const size_t count = io_detail::CheckWholeElements<T>(io_detail::ReadFull(fd, probe, sizeof(probe)));
+        if (count == 0) {
+            break;
+        }
+        v.AppendUninitialized(count, [&probe, count](T* dst) {
+            std::memcpy(static_cast<void*>(dst), probe, count * sizeof(T));
+            return count;
+        });
+        if (count < PROBE_COUNT) {
+            break;
+        }
+    }
+    return v.Size() - initial_size;
+}
+
+// Записывает содержимое нескольких векторов подряд одним вызовом writev,
+// без сериализации во временный буфер. Неполные записи дописываются
+template <typename... Ts>
+void WriteTo(int fd, const Vector<Ts>&... vectors) {
+    static_assert((std::is_trivially_copyable_v<Ts> && ...), "WriteTo requires trivially copyable types");
+    iovec iov[] = {iovec{const_cast<Ts*>(vectors.begin()), vectors.Size() * sizeof(Ts)}...};
+    io_detail::WriteVAll(fd, iov, sizeof...(Ts));
+}
+
+// Записывает шарды подряд: по одному сегменту writev на шард
+template <typename T>
+void WriteTo(int fd, const ShardedVector<T>& v) {
+    static_assert(std::is_trivially_copyable_v<T>, "WriteTo requires a trivially copyable type");
+    Vector<iovec> iov;
+    iov.Reserve(v.ShardCount());
+    for (size_t i = 0; i < v.ShardCount(); ++i) {
+        const Vector<T>& shard = v.Shard(i);
+        iov.PushBack(iovec{const_cast<T*>(shard.begin()), shard.Size() * sizeof(T)});
+    }
+    io_detail::WriteVAll(fd, iov.begin(), iov.Size());
+}
+
+// Записывает StringVector в формате StringVector::Serialize: число строк,
+// смещения и символы уходят тремя сегментами прямо из памяти вектора
+inline void WriteTo(int fd, const StringVector& v) {
+    if constexpr (sizeof(size_t) != sizeof(uint64_t)) {
+        Vector<char> buffer;
+        v.Serialize(buffer);
+        WriteTo(fd, buffer);
+    } else {
+        uint64_t count = v.Size();
+        uint64_t empty_offset = 0;
+        const Vector<size_t>& offsets = v.Offsets();
+        const std::string_view chars = v.Chars();
+        iovec iov[] = {
+                iovec{&count, sizeof(count)},
+                offsets.Size() != 0 ? iovec{const_cast<size_t*>(offsets.begin()), offsets.Size() * sizeof(size_t)}
+                                    : iovec{&empty_offset, sizeof(empty_offset)},
+                iovec{const_cast<char*>(chars.data()), chars.size()},
+        };
+        io_detail::WriteVAll(fd, iov, 3);
+    }
+}